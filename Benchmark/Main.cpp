@@ -0,0 +1,213 @@
+﻿// Benchmark.cpp : 放置内核的微基准测试，需在Deploy目录下运行以读取Instance/中的算例。
+//
+
+#include <benchmark/benchmark.h>
+
+#include "AdaptSelect.hpp"
+
+namespace mbp {
+
+	/// 固定种子和宽度的求解器及其基准轨迹，打分测试在轨迹快照的skyline上进行
+	class MpwBinPackBenchmark {
+	public:
+		MpwBinPackBenchmark(const string &ins_str, unsigned int seed = 42) : _env(ins_str), _ins(_env),
+			_solver(_ins.get_polygon_ptrs(), cal_bin_width(_ins), INF, seed) {
+			_solver.prepare_scratch(_scratch);
+			_solver._scratch = &_scratch;
+			_solver.set_base_rule(_solver._sort_rules[0]);
+			for (auto &checkpoint : _scratch.base_trace.checkpoints) {
+				_workspaces.emplace_back();
+				_solver.init_workspace(_workspaces.back());
+				_workspaces.back().skyline = checkpoint.skyline;
+			}
+		}
+
+		const Instance &instance() const { return _ins; }
+
+		/// 按输入顺序贪心构造一个完整解，返回放置的多边形数
+		size_t insert_bottom_left_score() {
+			MpwBinPack::Workspace &ws = _scratch.workspaces[0];
+			ws.polygons.assign(_solver._sort_rules[0].sequence);
+			_solver.insert_bottom_left_score(ws, _dst);
+			return _dst.size();
+		}
+
+		/// 在每个快照的最低段上对形状为shape的全部多边形打分，返回打分次数
+		size_t score(Shape shape) {
+			size_t score_num = 0;
+			placement_t placement{ 0, { 0, 0 }, Rotation::_0_ };
+			MpwBinPack::SkylinePatch skyline;
+			coord_t skyline_height, waste, x;
+			int score;
+			for (auto &ws : _workspaces) {
+				size_t skyline_index = _solver.find_bottom_skyline(ws);
+				for (size_t p = 0; p < _solver._shapes.size(); ++p) {
+					if (_solver._shapes[p] != shape) { continue; }
+					const MpwBinPack::PolygonDims &dims = _solver._dims[p];
+					bool fit = false;
+					switch (shape) {
+					case Shape::R:
+						fit = _solver.score_rect_for_skyline_bottom_left(ws, skyline_index, dims.rect.width, dims.rect.height, x, score);
+						fit |= _solver.score_rect_for_skyline_bottom_left(ws, skyline_index, dims.rect.height, dims.rect.width, x, score);
+						score_num += 2;
+						break;
+					case Shape::L:
+						fit = _solver.score_lshape_for_skyline_bottom_left(ws, skyline_index, dims.lshape, placement, skyline, skyline_height, waste);
+						++score_num;
+						break;
+					case Shape::T:
+						fit = _solver.score_tshape_for_skyline_bottom_left(ws, skyline_index, dims.tshape, placement, skyline, skyline_height);
+						++score_num;
+						break;
+					case Shape::C:
+						fit = _solver.score_concave_for_skyline_bottom_left(ws, skyline_index, dims.concave, placement, skyline, skyline_height);
+						++score_num;
+						break;
+					default: assert(false); break;
+					}
+					benchmark::DoNotOptimize(fit);
+				}
+			}
+			benchmark::ClobberMemory();
+			return score_num;
+		}
+
+		/// 在每个快照的最低段上对全部矩形批量打分，与score(Shape::R)对应
+		size_t score_rect_block() {
+			size_t score_num = 0;
+			for (auto &ws : _workspaces) {
+				size_t skyline_index = _solver.find_bottom_skyline(ws);
+				MpwBinPack::SkylineSpace space = _solver.skyline_nodo_to_space(ws, skyline_index);
+				RectBlock &block = ws.rect_block;
+				block.clear();
+				for (size_t p = 0; p < _solver._shapes.size(); ++p) {
+					if (_solver._shapes[p] != Shape::R) { continue; }
+					block.add(p, 0, _solver._dims[p].rect.width, _solver._dims[p].rect.height);
+				}
+				block.score(space.width, space.hl, space.hr);
+				benchmark::DoNotOptimize(block.score(block.size() - 1, true));
+				score_num += block.size() * 2;
+			}
+			benchmark::ClobberMemory();
+			return score_num;
+		}
+
+		/// 将每个快照的skyline节点拆成两段同高节点后合并，返回合并前的节点总数
+		size_t merge_skylines() {
+			size_t node_num = 0;
+			for (auto &ws : _workspaces) {
+				skyline_t &skyline = _skylines[&ws - _workspaces.data()];
+				skyline.clear();
+				for (auto &node : ws.skyline) {
+					coord_t half = node.width / 2;
+					skyline.push_back({ node.x, node.y, half });
+					skyline.push_back({ node.x + half, node.y, node.width - half });
+				}
+				node_num += skyline.size();
+				MpwBinPack::merge_skylines(skyline);
+				benchmark::DoNotOptimize(skyline.data());
+			}
+			return node_num;
+		}
+
+		void prepare_merge() { _skylines.resize(_workspaces.size()); }
+
+		/// 与AdaptSelect::cal_candidate_widths_on_sqrt的下界相同
+		static coord_t cal_bin_width(const Instance &ins) {
+			coord_t bin_width = floor(cfg.lb_scale * sqrt(ins.get_total_area()));
+			for (auto &ptr : ins.get_polygon_ptrs()) { bin_width = max(bin_width, ptr->max_length); }
+			return bin_width;
+		}
+
+	private:
+		Environment _env;
+		Instance _ins;
+		MpwBinPack _solver;
+		MpwBinPack::Scratch _scratch;              // 求解器在整个测试期间使用的缓冲
+		vector<MpwBinPack::Workspace> _workspaces; // 基准轨迹各快照的skyline
+		vector<skyline_t> _skylines;               // 合并测试的缓冲
+		vector<placement_t> _dst;
+	};
+
+}
+
+static void BM_InsertBottomLeftScore(benchmark::State &state, const string &ins_str) {
+	MpwBinPackBenchmark bench(ins_str);
+	size_t placement_num = 0;
+	for (auto _ : state) { placement_num += bench.insert_bottom_left_score(); }
+	state.counters["placements"] = benchmark::Counter(placement_num, benchmark::Counter::kIsRate);
+}
+
+static void BM_Score(benchmark::State &state, const string &ins_str, Shape shape) {
+	MpwBinPackBenchmark bench(ins_str);
+	if (bench.instance().get_polygon_num(shape) == 0) { state.SkipWithError("no polygon of this shape"); return; }
+	size_t score_num = 0;
+	for (auto _ : state) { score_num += bench.score(shape); }
+	state.counters["scores"] = benchmark::Counter(score_num, benchmark::Counter::kIsRate);
+}
+
+static void BM_ScoreRectBlock(benchmark::State &state, const string &ins_str) {
+	MpwBinPackBenchmark bench(ins_str);
+	if (bench.instance().get_polygon_num(Shape::R) == 0) { state.SkipWithError("no polygon of this shape"); return; }
+	size_t score_num = 0;
+	for (auto _ : state) { score_num += bench.score_rect_block(); }
+	state.counters["scores"] = benchmark::Counter(score_num, benchmark::Counter::kIsRate);
+}
+
+static void BM_MergeSkylines(benchmark::State &state, const string &ins_str) {
+	MpwBinPackBenchmark bench(ins_str);
+	bench.prepare_merge();
+	size_t node_num = 0;
+	for (auto _ : state) { node_num += bench.merge_skylines(); }
+	state.counters["nodes"] = benchmark::Counter(node_num, benchmark::Counter::kIsRate);
+}
+
+/// 每次迭代使用同一种子的新求解器，完成初始化后计时iter次邻域评估
+static void BM_RandomLocalSearch(benchmark::State &state, const string &ins_str) {
+	Environment env(ins_str);
+	Instance ins(env);
+	coord_t bin_width = MpwBinPackBenchmark::cal_bin_width(ins);
+	int iter = static_cast<int>(state.range(0));
+	for (auto _ : state) {
+		state.PauseTiming();
+		MpwBinPack solver(ins.get_polygon_ptrs(), bin_width, INF, 42);
+		solver.random_local_search(1);
+		state.ResumeTiming();
+		solver.random_local_search(iter);
+		benchmark::DoNotOptimize(solver.get_obj_area());
+	}
+	state.counters["neighbors"] = benchmark::Counter(static_cast<double>(iter) * state.iterations(), benchmark::Counter::kIsRate);
+}
+
+static vector<string> benchmark_instances() {
+	vector<string> ins_list;
+	for (int i = 1; i <= 10; ++i) { ins_list.push_back("polygon_area_etc_input_" + to_string(i)); }
+	for (string s : { "L", "T", "U" }) {
+		for (int n = 200; n <= 1000; n += 200) { ins_list.push_back(s + "n" + to_string(n) + "r40"); }
+	}
+	return ins_list;
+}
+
+int main(int argc, char *argv[]) {
+	benchmark::Initialize(&argc, argv);
+
+	unordered_map<Shape, string> mp{ {Shape::R, "R"}, {Shape::L, "L"}, {Shape::T, "T"}, {Shape::C, "U"} };
+	for (auto &ins : benchmark_instances()) {
+		if (!ifstream(Environment(ins).instance_path()).good()) {
+			cerr << "Error instance path: can not open " << Environment(ins).instance_path() << endl;
+			continue;
+		}
+		benchmark::RegisterBenchmark(("BM_InsertBottomLeftScore/" + ins).c_str(), BM_InsertBottomLeftScore, ins);
+		for (Shape shape : { Shape::R, Shape::L, Shape::T, Shape::C }) {
+			benchmark::RegisterBenchmark(("BM_Score" + mp[shape] + "/" + ins).c_str(), BM_Score, ins, shape);
+		}
+		benchmark::RegisterBenchmark(("BM_ScoreRBlock/" + ins).c_str(), BM_ScoreRectBlock, ins);
+		benchmark::RegisterBenchmark(("BM_MergeSkylines/" + ins).c_str(), BM_MergeSkylines, ins);
+		benchmark::RegisterBenchmark(("BM_RandomLocalSearch/" + ins).c_str(), BM_RandomLocalSearch, ins)
+			->Arg(64)->Unit(benchmark::kMillisecond);
+	}
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
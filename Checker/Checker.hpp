@@ -11,6 +11,7 @@
 #include <algorithm>
 
 #include "Data.hpp"
+#include "../SmartMPW/PolygonFile.hpp"
 
 using namespace std;
 
@@ -19,6 +20,10 @@ public:
 	Checker(const string &sol_path) : _sol_path(sol_path) { read_solution(); }
 
 	bool run() {
+		if (_read_error) { // ļʱټ飬ѽضϵĽ⵱
+			cout << "Error Solution Read: " << _sol_path << endl;
+			return false;
+		}
 		if (_in_polygon_num != _out_polygon_num) {
 			cout << "Error Polygon Number:" << endl
 				<< "In Polygon: " << _in_polygon_num << endl
@@ -39,17 +44,9 @@ public:
 				return false;
 			}
 		}
+		if (!check_overlap()) { return false; }
 		coord_t bin_width = 0, bin_height = 0;
 		for (auto &op : _out_polygon_ptrs) {
-			for (auto& ring : _out_rings) {
-				if (vis::bg::overlaps(ring, op->ring)) {
-					cout << "Error Polygon Overlap:" << endl
-						<< "Polygon 1: " << vis::bg::dsv(op->ring) << endl
-						<< "Polygon 2: " << vis::bg::dsv(ring) << endl;
-					return false;
-				}
-				_out_rings.push_back(op->ring);
-			}
 			bin_width = max(bin_width, max_element(op->ring.begin(), op->ring.end(),
 				[](auto &lhs, auto &rhs) { return lhs.x() < rhs.x(); })->x());
 			bin_height = max(bin_height, max_element(op->ring.begin(), op->ring.end(),
@@ -65,89 +62,136 @@ public:
 	}
 
 private:
+	/// ԸηֽνRֻཻľζȷصжϡ
+	/// ͬһεľڲཻ˾صڲཻ
+	bool check_overlap() const {
+		using int_point_t = vis::bg::model::point<long long, 2, vis::bg::cs::cartesian>;
+		using int_box_t = vis::bg::model::box<int_point_t>;
+		using box_value = pair<int_box_t, size_t>; // μ
+
+		vector<box_value> boxes;
+		for (size_t i = 0; i < _out_polygon_ptrs.size(); ++i) {
+			for (auto &rect : _out_polygon_ptrs[i]->rects) {
+				boxes.emplace_back(int_box_t(int_point_t(rect.x1, rect.y1), int_point_t(rect.x2, rect.y2)), i);
+			}
+		}
+		vis::bgi::rtree<box_value, vis::bgi::rstar<16>> rtree(boxes.begin(), boxes.end());
+
+		auto to_rect = [](const int_box_t &box) {
+			return IntRect{ box.min_corner().get<0>(), box.min_corner().get<1>(), box.max_corner().get<0>(), box.max_corner().get<1>() };
+		};
+		vector<box_value> candidates;
+		for (auto &box : boxes) {
+			candidates.clear();
+			rtree.query(vis::bgi::intersects(box.first), back_inserter(candidates));
+			IntRect rect1 = to_rect(box.first);
+			for (auto &candidate : candidates) {
+				if (candidate.second <= box.second) { continue; } // ÿԶֻӱСһ
+				if (rect1.overlaps(to_rect(candidate.first))) {
+					cout << "Error Polygon Overlap:" << endl
+						<< "Polygon 1: " << vis::bg::dsv(_out_polygon_ptrs[box.second]->ring) << endl
+						<< "Polygon 2: " << vis::bg::dsv(_out_polygon_ptrs[candidate.second]->ring) << endl;
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	/// ӳļѡƻıν
 	void read_solution() {
-		ifstream ifs(_sol_path);
-		if (!ifs.is_open()) {
+		_in_polygon_num = _out_polygon_num = 0;
+		_in_total_area = _out_total_area = 0;
+		_read_error = false;
+
+		utils::MappedFile file(_sol_path);
+		if (!file.is_open()) {
 			cerr << "Error solution path: can not open " << _sol_path << endl;
+			_read_error = true;
 			return;
 		}
+		if (polygon_file::is_binary(file.data(), file.size())) { read_binary_solution(file); }
+		else { read_text_solution(file); }
+	}
 
-		_in_polygon_num = _out_polygon_num = 0;
-		_in_total_area = _out_total_area = 0;
+	void read_text_solution(const utils::MappedFile &file) {
+		const char *begin = file.data(), *end = begin + file.size();
 		size_t count = 0;
-		string line;
-		while (getline(ifs, line)) {
-			if (line == "In Polygon:" || line == "Out Polygon:" || line == "Polygon:") { continue; }
-
-			++count;
-			stringstream ss(line);
-			char l_bracket, comma, r_bracket;
-			coord_t x, y;
-			vector<point_t> points;
-			while (ss >> l_bracket >> x >> comma >> y >> r_bracket) {
-				assert(l_bracket == '(' && comma == ',' && r_bracket == ')');
-				points.push_back({ x, y });
+		vector<point_t> points;
+		int line_no = 1;
+		for (const char *line = begin; line < end; ++line_no) {
+			const char *line_end = static_cast<const char *>(memchr(line, '\n', end - line));
+			if (!line_end) { line_end = end; }
+			if (*line == '(') {
+				const char *pos = line;
+				if (const char *error = polygon_file::TextScanner::parse_points(pos, line_end, points)) {
+					cerr << "Error solution format: " << _sol_path << ":" << line_no << ":" << pos - line + 1 << ": " << error << endl;
+					_read_error = true;
+					return;
+				}
+				const char *str_end = line_end > line && line_end[-1] == '\r' ? line_end - 1 : line_end;
+				add_polygon(++count % 2, string(line, str_end), points);
 			}
+			line = line_end + 1;
+		}
+	}
 
-			vector<segment_t> segments = transform_points_to_segments(points);
-
-			switch (segments.size()) {
-			case 4: {
-				if (count % 2) {
-					_in_polygon_ptrs.emplace_back(make_shared<rect_t>(_in_polygon_num++, line, points, segments));
-					_in_total_area += _in_polygon_ptrs.back()->area;
-				}
-				else {
-					_out_polygon_ptrs.emplace_back(make_shared<rect_t>(_out_polygon_num++, line, points, segments));
-					_out_total_area += _out_polygon_ptrs.back()->area;
-				}
-				break;
+	void read_binary_solution(const utils::MappedFile &file) {
+		polygon_file::View view;
+		if (const char *error = view.open(file.data(), file.size(), polygon_file::Kind::Solution)) {
+			cerr << "Error solution format: " << _sol_path << ": " << error << endl;
+			_read_error = true;
+			return;
+		}
+		vector<point_t> points;
+		for (size_t i = 0; i < view.record_num(); ++i) {
+			const polygon_file::XY *xy = view.points(i);
+			points.clear();
+			string str;
+			for (size_t j = 0; j < view.point_num(i); ++j) {
+				points.push_back({ static_cast<coord_t>(xy[j].x), static_cast<coord_t>(xy[j].y) });
+				str += "(" + to_string(xy[j].x) + "," + to_string(xy[j].y) + ")";
 			}
-			case 6: {
-				if (count % 2) {
-					_in_polygon_ptrs.emplace_back(make_shared<lshape_t>(_in_polygon_num++, line, points, segments));
-					_in_total_area += _in_polygon_ptrs.back()->area;
-				}
-				else {
-					_out_polygon_ptrs.emplace_back(make_shared<lshape_t>(_out_polygon_num++, line, points, segments));
-					_out_total_area += _out_polygon_ptrs.back()->area;
-				}
+			add_polygon(i % 2 == 0, str, points);
+		}
+	}
+
+	void add_polygon(bool in, const string &str, const vector<point_t> &points) {
+		vector<segment_t> segments = transform_points_to_segments(points);
+		vector<polygon_ptr> &polygon_ptrs = in ? _in_polygon_ptrs : _out_polygon_ptrs;
+		size_t &polygon_num = in ? _in_polygon_num : _out_polygon_num;
+		coord_t &total_area = in ? _in_total_area : _out_total_area;
+
+		switch (segments.size()) {
+		case 4: {
+			polygon_ptrs.emplace_back(make_shared<rect_t>(polygon_num++, str, points, segments));
+			break;
+		}
+		case 6: {
+			polygon_ptrs.emplace_back(make_shared<lshape_t>(polygon_num++, str, points, segments));
+			break;
+		}
+		case 8: {
+			switch (get_shape_from_segments(segments)) {
+			case Shape::T: {
+				polygon_ptrs.emplace_back(make_shared<tshape_t>(polygon_num++, str, points, segments));
 				break;
 			}
-			case 8: {
-				switch (get_shape_from_segments(segments)) {
-				case Shape::T: {
-					if (count % 2) {
-						_in_polygon_ptrs.emplace_back(make_shared<tshape_t>(_in_polygon_num++, line, points, segments));
-						_in_total_area += _in_polygon_ptrs.back()->area;
-					}
-					else {
-						_out_polygon_ptrs.emplace_back(make_shared<tshape_t>(_out_polygon_num++, line, points, segments));
-						_out_total_area += _out_polygon_ptrs.back()->area;
-					}
-					break;
-				}
-				case Shape::C: {
-					if (count % 2) {
-						_in_polygon_ptrs.emplace_back(make_shared<concave_t>(_in_polygon_num++, line, points, segments));
-						_in_total_area += _in_polygon_ptrs.back()->area;
-					}
-					else {
-						_out_polygon_ptrs.emplace_back(make_shared<concave_t>(_out_polygon_num++, line, points, segments));
-						_out_total_area += _out_polygon_ptrs.back()->area;
-					}
-					break;
-				}
-				default: { assert(false); break; }
-				}
+			case Shape::C: {
+				polygon_ptrs.emplace_back(make_shared<concave_t>(polygon_num++, str, points, segments));
 				break;
 			}
-			default:
-				cerr << "Error Shape: has " << segments.size() << " segments." << endl;
-				assert(false);
-				break;
+			default: { assert(false); _read_error = true; return; }
 			}
+			break;
 		}
+		default:
+			cerr << "Error Shape: has " << segments.size() << " segments." << endl;
+			assert(false);
+			_read_error = true;
+			return;
+		}
+		total_area += polygon_ptrs.back()->area;
 	}
 
 	vector<segment_t> transform_points_to_segments(const vector<point_t> &points) {
@@ -180,8 +224,7 @@ private:
 	size_t _out_polygon_num;
 	coord_t _in_total_area;
 	coord_t _out_total_area;
-
-	vector<vis::bg_ring_t> _out_rings;
+	bool _read_error;  // 򿪻ʧܣѶĶβ
 };
 
 
@@ -9,6 +9,7 @@
 #include <vector>
 #include <memory>
 #include <cassert>
+#include <algorithm>
 
 #include "Visualizer.hpp"
 
@@ -72,6 +73,57 @@ struct Segment {
 	}
 };
 
+/// [x1, x2][y1, y2]ڲཻʱΪص߻򹲵㲻
+struct IntRect {
+	long long x1, y1, x2, y2;
+
+	bool overlaps(const IntRect &rhs) const { return x1 < rhs.x2 && rhs.x1 < x2 && y1 < rhs.y2 && rhs.y1 < y2; }
+};
+
+/// yгˮƽverticalʱxгֱڿԽıΧ䣬
+/// ·ͬʱΡõľڲཻ
+template<typename T>
+std::vector<IntRect> slab_decompose(const std::vector<Point<T>> &points, bool vertical) {
+	// ͳһˮƽuΪڵ꣬vΪзַ
+	auto u = [vertical](const Point<T> &p) { return static_cast<long long>(vertical ? p.y : p.x); };
+	auto v = [vertical](const Point<T> &p) { return static_cast<long long>(vertical ? p.x : p.y); };
+	std::vector<long long> vs;
+	for (auto &point : points) { vs.push_back(v(point)); }
+	std::sort(vs.begin(), vs.end());
+	vs.erase(std::unique(vs.begin(), vs.end()), vs.end());
+
+	std::vector<IntRect> rects;
+	std::vector<long long> us;
+	for (size_t k = 0; k + 1 < vs.size(); ++k) {
+		us.clear();
+		for (size_t i = 0; i < points.size(); ++i) {
+			const Point<T> &a = points[i], &b = points[(i + 1) % points.size()];
+			if (u(a) != u(b)) { continue; }
+			if (std::min(v(a), v(b)) <= vs[k] && std::max(v(a), v(b)) >= vs[k + 1]) { us.push_back(u(a)); }
+		}
+		std::sort(us.begin(), us.end());
+		for (size_t j = 0; j + 1 < us.size(); j += 2) {
+			auto rect = std::find_if(rects.begin(), rects.end(), [&](const IntRect &r) {
+				return r.x1 == us[j] && r.x2 == us[j + 1] && r.y2 == vs[k]; });
+			if (rect != rects.end()) { rect->y2 = vs[k + 1]; }
+			else { rects.push_back({ us[j], vs[k], us[j + 1], vs[k + 1] }); }
+		}
+	}
+	if (vertical) {
+		for (auto &rect : rects) { std::swap(rect.x1, rect.y1); std::swap(rect.x2, rect.y2); }
+	}
+	return rects;
+}
+
+/// ȡˮƽֱзоνٵһ֣R/L/T/U3
+template<typename T>
+std::vector<IntRect> decompose_rectilinear(const std::vector<Point<T>> &points) {
+	std::vector<IntRect> horizontal = slab_decompose(points, false);
+	if (horizontal.size() <= 1) { return horizontal; }
+	std::vector<IntRect> vertical = slab_decompose(points, true);
+	return vertical.size() < horizontal.size() ? vertical : horizontal;
+}
+
 template<typename> struct Polygon;
 template<typename T>
 bool operator==(const Polygon<T> &lhs, const Polygon<T> &rhs) {
@@ -87,6 +139,7 @@ struct Polygon {
 	const int id;
 	const std::string str;
 	vis::bg_ring_t ring;
+	std::vector<IntRect> rects; // صʹõηֽ
 	T area;
 
 	friend bool operator==<T>(const Polygon&, const Polygon&);
@@ -95,6 +148,7 @@ struct Polygon {
 
 	Polygon(int id_, const std::string &str_, const std::vector<Point<T>> &points) : id(id_), str(str_) {
 		for (auto &point : points) { vis::bg::append(ring, vis::bg_point_t(point.x, point.y)); }
+		rects = decompose_rectilinear(points);
 		area = abs(vis::bg::area(ring));
 	}
 
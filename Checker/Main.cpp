@@ -19,7 +19,18 @@ static const char *sol_list[]{
 	"polygon_area_etc_input_13"
 };
 
-int main() {
+int main(int argc, char *argv[]) {
+
+	if (argc > 1) { // 检查命令行给出的解文件，文本或二进制格式均可
+		bool all_valid = true;
+		for (int i = 1; i < argc; ++i) {
+			cout << "load solution " << argv[i] << endl;
+			string sol_path(argv[i]);
+			Checker checker(sol_path);
+			all_valid &= checker.run();
+		}
+		return all_valid ? 0 : 1;
+	}
 
 	for (auto &sol : sol_list) {
 		cout << "load solution " << sol << endl;
@@ -8,6 +8,7 @@
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point_xy.hpp>
 #include <boost/geometry/geometries/geometries.hpp>
+#include <boost/geometry/index/rtree.hpp>
 
 using coord_t = double;
 
@@ -15,6 +16,7 @@ using coord_t = double;
 namespace utils_visualize {
 
 	namespace bg = boost::geometry;
+	namespace bgi = boost::geometry::index;
 
 	using T = coord_t;
 
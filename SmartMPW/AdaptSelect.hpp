@@ -5,20 +5,29 @@
 #ifndef SMARTMPW_ADAPTSELECT_HPP
 #define SMARTMPW_ADAPTSELECT_HPP
 
-#include <future>
+#include <mutex>
 
 #include "Instance.hpp"
 #include "MpwBinPack.hpp"
+#include "ThreadPool.hpp"
 
 using namespace mbp;
+using namespace utils;
 
 class AdaptSelect {
 
 	/// ѡȶ
 	struct CandidateWidth {
 		coord_t value;
+		coord_t lb_area;  // ½value*ceil(total_area/value)Сڵǰʱÿȱ֦
 		int iter;
-		unique_ptr<MpwBinPack> mbp_solver; // ָ룬ɵĿ
+		coord_t obj_area; // RLSʱͬĿֵʹãеɶ
+		int improved_num; // RLSĽobj_areaĴ
+		int stagnant_num; // RLSδĽobj_areaĴ
+		bool stagnant;    // һRLSǷδĽΪʱһεӱ
+		bool busy;        // Ƿĳ̽ռ
+		bool pruned;      // Ƿѱ֦֦ͷ
+		unique_ptr<MpwBinPack> mbp_solver;
 	};
 
 public:
@@ -27,74 +36,99 @@ public:
 
 	AdaptSelect(const Environment &env, const Config &cfg) :
 		_env(env), _cfg(cfg), _ins(env), _gen(_cfg.random_seed),
-		_obj_area(numeric_limits<coord_t>::max()) {}
+		_obj_area(numeric_limits<coord_t>::max()), _pool(nullptr), _chain_num(0) {}
 
 	void run() {
 
-		_start = clock();
+		if (_ins.load_failed()) { return; } // Instance
+
+		_deadline = Deadline(_cfg.ub_asa_time);
 
 		//vector<coord_t> candidate_widths = cal_candidate_widths_on_interval();
 		vector<coord_t> candidate_widths = cal_candidate_widths_on_sqrt();
-		vector<CandidateWidth> cw_objs; cw_objs.reserve(candidate_widths.size());
+		auto polygon_store = MpwBinPack::make_polygon_store(_ins.get_polygon_ptrs()); // ѡȹ
+		ShapeSet shapes = 0; // ʵ״ѡػ
+		for (Shape shape : { Shape::R, Shape::L, Shape::T, Shape::C }) {
+			if (_ins.get_polygon_num(shape) > 0) { shapes |= shape_bit(shape); }
+		}
+		_cw_objs.clear(); _cw_objs.reserve(candidate_widths.size());
+		for (coord_t bin_width : candidate_widths) { // ÿѡʹö
+			coord_t lb_area = bin_width * ((_ins.get_total_area() + bin_width - 1) / bin_width);
+			_cw_objs.push_back({ bin_width, lb_area, 1, numeric_limits<coord_t>::max(), 0, 0, true, false, false, unique_ptr<MpwBinPack>(
+				new MpwBinPack(polygon_store, shapes, bin_width, INF, _gen())) });
+		}
+
+		// ߳wait()ڼͬ
+		ThreadPool pool(max(_cfg.thread_num, 1u) - 1);
+		TaskGroup group(pool);
 
 		// ֧ʼiter=1
-		// ߳
-		for (coord_t bin_width : candidate_widths) {
-			cw_objs.push_back({ bin_width, 1, unique_ptr<MpwBinPack>(
-				new MpwBinPack(_ins.get_polygon_ptrs(), bin_width, INF, _gen)) });
-			cw_objs.back().mbp_solver->random_local_search(1);
-			check_cwobj(cw_objs.back());
-		}
-		// ߳ ==> async
-		//vector<future<void>> futures; futures.reserve(candidate_widths.size());
-		//for (coord_t bin_width : candidate_widths) {
-		//	cw_objs.push_back({ bin_width, 1, unique_ptr<MpwBinPack>(
-		//		new MpwBinPack(_ins.get_polygon_ptrs(), bin_width, INF, _gen)) });
-		//	futures.push_back(async(&MpwBinPack::random_local_search, cw_objs.back().mbp_solver.get(), 1));
-		//	//futures.push_back(async([&]() { cw_objs.back().mbp_solver->random_local_search(1); }));
-		//}
-		//for (auto &f : futures) { f.wait(); }
-		//for (auto &cw_obj : cw_objs) { check_cwobj(cw_obj); }
-
-		// УԽѡиԽ
-		sort(cw_objs.begin(), cw_objs.end(), [](const CandidateWidth &lhs, const CandidateWidth &rhs) {
-			return lhs.mbp_solver->get_obj_area() > rhs.mbp_solver->get_obj_area(); });
-
-		// ʼɢʷֲ
-		vector<int> probs; probs.reserve(cw_objs.size());
-		for (int i = 1; i <= cw_objs.size(); ++i) { probs.push_back(2 * i); }
-		discrete_distribution<> discrete_dist(probs.begin(), probs.end());
-
-		// Ż
-		int curr_iter = 0; _iteration = 0;
-		while (static_cast<double>(clock() - _start) / CLOCKS_PER_SEC < _cfg.ub_asa_time) {
-			//&& curr_iter - _iteration < _cfg.ub_asa_iter) {
-			CandidateWidth &picked_width = cw_objs[discrete_dist(_gen)];
-			picked_width.iter = min(2 * picked_width.iter, _cfg.ub_rls_iter);
-			picked_width.mbp_solver->set_bin_height(coord_t(floor(1.0 * _obj_area / picked_width.value)));
-			picked_width.mbp_solver->random_local_search(picked_width.iter);
-			check_cwobj(picked_width, ++curr_iter);
-			sort(cw_objs.begin(), cw_objs.end(), [](const CandidateWidth &lhs, const CandidateWidth &rhs) {
-				return lhs.mbp_solver->get_obj_area() > rhs.mbp_solver->get_obj_area(); });
+		for (auto &cw_obj : _cw_objs) {
+			group.run([this, &cw_obj]() {
+				{
+					lock_guard<mutex> guard(_mtx);
+					if (_deadline.expired() && !_dst.empty()) { // ʱн⣬
+						cw_obj.pruned = true;
+						cw_obj.mbp_solver.reset();
+						return;
+					}
+				}
+				cw_obj.mbp_solver->random_local_search(1);
+				lock_guard<mutex> guard(_mtx);
+				check_cwobj(cw_obj);
+			});
+		}
+		group.wait();
+		prune_cwobjs();
+
+		// Żÿ̽ռһ߳
+		_curr_iter = 0; _iteration = 0;
+		_pool = &pool;
+		size_t chain_num = min<size_t>(pool.size() + 1, _cw_objs.size());
+		_chain_num = chain_num;
+		for (size_t i = 0; i < chain_num; ++i) {
+			default_random_engine chain_gen(_gen());
+			group.run([this, &group, chain_gen]() { explore(group, chain_gen); });
 		}
+		group.wait();
+
+		make_dst_nodes(group);
 	}
 
+	coord_t get_obj_area() const { return _obj_area; }
+
+	/// ʵȡʧʱrun()⣬ҲӦ¼
+	bool load_failed() const { return _ins.load_failed(); }
+
 	void record_sol(const string &sol_path) const {
-		ofstream ofs(sol_path);
-		for (auto &dst_node : _dst) {
-			ofs << "In Polygon:" << endl;
-			for (auto &point : *dst_node->in_points) { ofs << "(" << point.x << "," << point.y << ")"; }
-			dst_node->to_out_points();
-			ofs << endl << "Out Polygon:" << endl;
-			for_each(dst_node->out_points.begin(), dst_node->out_points.end(),
-				[&](point_t &point) { ofs << "(" << point.x << "," << point.y << ")"; });
-			ofs << endl;
+		if (polygon_file::has_binary_extension(sol_path)) { record_sol_binary(sol_path); return; }
+		utils::BufferedWriter writer(sol_path);
+		auto write_points = [&writer](const auto &points) {
+			for (auto &point : points) { writer << '(' << point.x << ',' << point.y << ')'; }
+		};
+		for (auto &dst_node : _dst_nodes) {
+			writer << "In Polygon:\n";
+			write_points(dst_node->in_points);
+			writer << "\nOut Polygon:\n";
+			write_points(dst_node->out_points);
+			writer << '\n';
+		}
+	}
+
+	/// νд룬״ǩȡ
+	void record_sol_binary(const string &sol_path) const {
+		polygon_file::Writer writer(polygon_file::Kind::Solution);
+		for (auto &dst_node : _dst_nodes) {
+			uint8_t tag = static_cast<uint8_t>(dst_node->shape());
+			writer.add(tag, dst_node->in_points);
+			writer.add(tag, dst_node->out_points);
 		}
+		writer.save(sol_path);
 	}
 
 	void draw_sol(const string &html_path) const {
 		utils_visualize_drawer::Drawer html_drawer(html_path, _cfg.ub_width, _cfg.ub_height);
-		for (auto &dst_node : _dst) {
+		for (auto &dst_node : _dst_nodes) {
 			string polygon_str;
 			for_each(dst_node->out_points.begin(), dst_node->out_points.end(),
 				[&](point_t &point) { polygon_str += to_string(point.x) + "," + to_string(point.y) + " "; });
@@ -109,7 +143,7 @@ public:
 		utils_visualize_drawer::Drawer html_drawer(_env.ins_html_path(), _cfg.ub_width, _cfg.ub_height);
 		for (auto &src_node : _ins.get_polygon_ptrs()) {
 			string polygon_str;
-			for_each(src_node->in_points->begin(), src_node->in_points->end(),
+			for_each(src_node->in_points.begin(), src_node->in_points.end(),
 				[&](const point_t &point) { polygon_str += to_string(point.x) + "," + to_string(point.y) + " "; });
 			html_drawer.polygon(polygon_str);
 		}
@@ -129,7 +163,7 @@ public:
 			<< _obj_area << "," << _fill_ratio << ","
 			<< _width << "," << _height << "," << _wh_ratio << ","
 			<< _iteration << "," << _duration << ","
-			<< static_cast<double>(clock() - _start) / CLOCKS_PER_SEC << "," 
+			<< _deadline.elapsed() << "," 
 			<< _cfg.lb_scale << "," << _cfg.ub_scale << "," << _cfg.random_seed << endl;
 	}
 
@@ -180,23 +214,121 @@ private:
 		return candidate_widths;
 	}
 
-	/// cw_objRLS
-	void check_cwobj(const CandidateWidth &cw_obj, int curr_iter = 0) {
-		coord_t cw_height = cw_obj.mbp_solver->get_obj_area() / cw_obj.value;
+	/// ̽ThompsonѡеĺѡȽRLSɺύֱʱ
+	/// һRLSδĽʱӱĽʱֲ
+	void explore(TaskGroup &group, default_random_engine gen) {
+		CandidateWidth *picked_width;
+		coord_t bin_height, prev_obj_area;
+		size_t batch_size;
+		{
+			lock_guard<mutex> guard(_mtx);
+			if (_deadline.expired()) { --_chain_num; return; }
+				//|| _curr_iter - _iteration >= _cfg.ub_asa_iter) { return; }
+			picked_width = claim_cwobj(gen);
+			if (!picked_width) { --_chain_num; return; } // ĿȾռã
+			if (picked_width->stagnant) { picked_width->iter = min(2 * picked_width->iter, _cfg.ub_rls_iter); }
+			bin_height = coord_t(floor(1.0 * _obj_area / picked_width->value));
+			prev_obj_area = picked_width->obj_area;
+			batch_size = cal_batch_size();
+		}
+		picked_width->mbp_solver->set_batch(_pool, batch_size);
+		picked_width->mbp_solver->set_bin_height(bin_height);
+		picked_width->mbp_solver->random_local_search(picked_width->iter, _deadline);
+		{
+			lock_guard<mutex> guard(_mtx);
+			check_cwobj(*picked_width, ++_curr_iter);
+			picked_width->stagnant = picked_width->obj_area >= prev_obj_area;
+			++(picked_width->stagnant ? picked_width->stagnant_num : picked_width->improved_num);
+			picked_width->busy = false;
+			prune_cwobjs();
+		}
+
+		group.run([this, &group, gen]() { explore(group, gen); });
+	}
+
+	/// ThompsonÿпȴBeta(1+improved_num, 1+stagnant_num)вĽʣ
+	/// 뵱ǰŵĽӽ̶_obj_area/obj_areaȡߡ÷_mtx
+	CandidateWidth *claim_cwobj(default_random_engine &gen) {
+		CandidateWidth *picked_width = nullptr;
+		double best_score = -1;
+		for (auto &cw_obj : _cw_objs) {
+			if (cw_obj.busy || cw_obj.pruned) { continue; }
+			gamma_distribution<double> improved_dist(1.0 + cw_obj.improved_num), stagnant_dist(1.0 + cw_obj.stagnant_num);
+			double x = improved_dist(gen), y = stagnant_dist(gen);
+			double score = x / (x + y) * _obj_area / cw_obj.obj_area;
+			if (score > best_score) {
+				best_score = score;
+				picked_width = &cw_obj;
+			}
+		}
+		if (picked_width) { picked_width->busy = true; }
+		return picked_width;
+	}
+
+	/// ̰߳е֣̽ȱ֦߳ڿڵ
+	/// ÿRLSǰ¼㣬Config::rls_batch0ʱ̶ʹøֵ÷_mtx
+	size_t cal_batch_size() const {
+		if (_cfg.rls_batch) { return _cfg.rls_batch; }
+		size_t width_num = count_if(_cw_objs.begin(), _cw_objs.end(), [](const CandidateWidth &cw_obj) { return !cw_obj.pruned; });
+		size_t parallel_num = max<size_t>(min(_chain_num, width_num), 1);
+		return max<size_t>((_pool->size() + 1) / parallel_num, 1);
+	}
+
+	/// ֦½粻ڵǰŽĿпȲͷռõĿͷźټ顣÷_mtx
+	void prune_cwobjs() {
+		for (auto &cw_obj : _cw_objs) {
+			if (cw_obj.busy || cw_obj.pruned || cw_obj.lb_area < _obj_area) { continue; }
+			cw_obj.pruned = true;
+			cw_obj.mbp_solver.reset();
+		}
+	}
+
+	/// ¼İڷλõĶΣout_points
+	/// Žɴout_pointsĶΣrecord_soldraw_soláֿ̳߳ϲмout_points
+	void make_dst_nodes(TaskGroup &group) {
+		static constexpr size_t ChunkSize = 64;
+		_dst_nodes.assign(_dst.size(), nullptr);
+		for (size_t beg = 0; beg < _dst.size(); beg += ChunkSize) {
+			group.run([this, beg]() {
+				for (size_t i = beg; i < min(beg + ChunkSize, _dst.size()); ++i) {
+					const placement_t &placement = _dst[i];
+					const polygon_ptr &src_node = _ins.get_polygon_ptrs().at(placement.id);
+					polygon_ptr dst_node;
+					switch (src_node->shape()) {
+					case Shape::R: dst_node = make_shared<rect_t>(*dynamic_pointer_cast<rect_t>(src_node)); break;
+					case Shape::L: dst_node = make_shared<lshape_t>(*dynamic_pointer_cast<lshape_t>(src_node)); break;
+					case Shape::T: dst_node = make_shared<tshape_t>(*dynamic_pointer_cast<tshape_t>(src_node)); break;
+					case Shape::C: dst_node = make_shared<concave_t>(*dynamic_pointer_cast<concave_t>(src_node)); break;
+					default: assert(false); break;
+					}
+					dst_node->lb_point = placement.lb_point;
+					dst_node->rotation = placement.rotation;
+					dst_node->to_out_points();
+					_dst_nodes[i] = move(dst_node);
+				}
+			});
+		}
+		group.wait();
+	}
+
+	/// cw_objRLS÷_mtx
+	void check_cwobj(CandidateWidth &cw_obj, int curr_iter = 0) {
+		cw_obj.obj_area = cw_obj.mbp_solver->get_obj_area();
+		coord_t cw_height = cw_obj.obj_area / cw_obj.value;
 		//if (cw_height > _cfg.ub_height) { // ߶ȳϽ磬Ϸ
 		//	cw_obj.mbp_solver->set_obj_area(numeric_limits<coord_t>::max());
 		//}
 		//if (cw_height < _cfg.lb_height) { // ߶Ȳ½磬½
 		//	cw_obj.mbp_solver->set_obj_area(cw_obj.value * _cfg.lb_height);
 		//}
-		if (cw_obj.mbp_solver->get_obj_area() < _obj_area) {
-			_obj_area = cw_obj.mbp_solver->get_obj_area();
+		if (cw_obj.obj_area < _obj_area) {
+			_obj_area = cw_obj.obj_area;
 			_fill_ratio = 1.0 * _ins.get_total_area() / _obj_area;
 			_width = cw_obj.value;
 			_height = cw_height;
 			_wh_ratio = 1.0 * max(_width, _height) / min(_width, _height);
 			_dst = cw_obj.mbp_solver->get_dst();
-			_duration = static_cast<double>(clock() - _start) / CLOCKS_PER_SEC;
+			_duration = _deadline.elapsed();
 			_iteration = curr_iter;
 		}
 	}
@@ -207,16 +339,23 @@ private:
 
 	const Instance _ins;
 	default_random_engine _gen;
-	clock_t _start;
+	Deadline _deadline; // ASAʱԤ㣬ǽʱ
 	double _duration; // Žʱ
 	int _iteration;   // Žֵ
+	int _curr_iter;   // ɵRLS
 
 	coord_t _obj_area;
 	double _fill_ratio;
 	coord_t _width;
 	coord_t _height;
 	double _wh_ratio;
-	vector<polygon_ptr> _dst;
+	vector<placement_t> _dst;
+	vector<polygon_ptr> _dst_nodes; // ŽӦΣrunʱ
+
+	vector<CandidateWidth> _cw_objs;
+	ThreadPool *_pool;  // run()ڼ̳߳أڵʹ
+	size_t _chain_num;  // δ̽
+	mutex _mtx; // ѡȵĵ״̬͵ǰŽ
 };
 
 #endif // SMARTMPW_ADAPTSELECT_HPP
@@ -12,6 +12,7 @@
 #endif // !NDEBUG
 
 #include <random>
+#include <thread>
 
 using coord_t = int;
 
@@ -23,6 +24,8 @@ struct Config {
 	int ub_rls_iter = 9999;  // RLS
 	int ub_asa_iter = 9999;  // ASA
 	int ub_asa_time = 300;   // ASAʱʱ
+	unsigned thread_num = std::thread::hardware_concurrency(); // ASA߳
+	unsigned rls_batch = 0;  // RLSÿֲ0ʾɸ߳
 
 	coord_t lb_width = 50, ub_width = 400;
 	coord_t lb_height = 50, ub_height = 300;
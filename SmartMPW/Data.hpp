@@ -73,10 +73,28 @@ struct Segment {
 	}
 };
 
+/// еһ꣬ͬһʵһ
+template<typename T>
+class PointSlice {
+public:
+	PointSlice(std::shared_ptr<const std::vector<Point<T>>> pool, size_t first, size_t last) :
+		_pool(std::move(pool)), _first(first), _last(last) {}
+
+	const Point<T> *begin() const { return _pool->data() + _first; }
+	const Point<T> *end() const { return _pool->data() + _last; }
+	size_t size() const { return _last - _first; }
+	const Point<T> &operator[](size_t i) const { return begin()[i]; }
+
+private:
+	std::shared_ptr<const std::vector<Point<T>>> _pool;
+	size_t _first; // ڵеķΧ[_first, _last)
+	size_t _last;
+};
+
 template<typename T>
 struct Polygon {
 	const int id;
-	const std::shared_ptr<const std::vector<Point<T>>> in_points; // 
+	const PointSlice<T> in_points; // 
 	T area;
 	T max_length;
 	T min_length;
@@ -84,8 +102,8 @@ struct Polygon {
 	Rotation rotation; // תǶȣ⣩
 	std::vector<Point<T>> out_points; // 
 
-	Polygon(int id_, const std::vector<Point<T>> &points, const std::vector<Segment<T>> &segments) :
-		id(id_), in_points(std::make_shared<const std::vector<Point<T>>>(points)),
+	Polygon(int id_, const PointSlice<T> &points, const std::vector<Segment<T>> &segments) :
+		id(id_), in_points(points),
 		lb_point(0, 0), rotation(Rotation::_0_),
 		max_length(max_element(segments.begin(), segments.end(),
 			[](const Segment<T> &lhs, const Segment<T> &rhs) { return lhs.len < rhs.len; })->len),
@@ -100,7 +118,7 @@ template<typename T>
 struct Rect : public Polygon<T> {
 	T width, height;
 
-	Rect(int id, const std::vector<Point<T>> &points, const std::vector<Segment<T>> &segments)
+	Rect(int id, const PointSlice<T> &points, const std::vector<Segment<T>> &segments)
 		: Polygon<T>(id, points, segments) {
 		assert(segments.size() == 4);
 		width = segments[0].len;
@@ -128,7 +146,7 @@ struct LShape : public Polygon<T> {
 	T hd, hm, hu; // hd=hm+hu
 	T vl, vm, vr; // vl=vm+vr
 
-	LShape(int id, const std::vector<Point<T>> &points, const std::vector<Segment<T>> &segments)
+	LShape(int id, const PointSlice<T> &points, const std::vector<Segment<T>> &segments)
 		: Polygon<T>(id, points, segments) {
 		std::vector<size_t> up_segs; up_segs.reserve(2);
 		std::vector<size_t> down_segs; down_segs.reserve(2);
@@ -281,7 +299,7 @@ struct TShape : public Polygon<T> {
 	T hu, hl, hr, hd; // hu+hl+hr=hd
 	T vlu, vld, vru, vrd; // vlu+vld=vru+vrd
 
-	TShape(int id, const std::vector<Point<T>> &points, const std::vector<Segment<T>> &segments)
+	TShape(int id, const PointSlice<T> &points, const std::vector<Segment<T>> &segments)
 		: Polygon<T>(id, points, segments) {
 		std::vector<size_t> up_segs; up_segs.reserve(3);
 		std::vector<size_t> down_segs; down_segs.reserve(3);
@@ -458,7 +476,7 @@ struct Concave : public Polygon<T> {
 	T hu, hl, hr, hd; // hu+hl+hr=hd
 	T vlu, vld, vru, vrd; // vld-vlu=vrd-vru
 
-	Concave(int id, const std::vector<Point<T>> &points, const std::vector<Segment<T>> &segments)
+	Concave(int id, const PointSlice<T> &points, const std::vector<Segment<T>> &segments)
 		: Polygon<T>(id, points, segments) {
 		std::vector<size_t> up_segs; up_segs.reserve(3);
 		std::vector<size_t> down_segs; down_segs.reserve(3);
@@ -594,6 +612,14 @@ struct Concave : public Polygon<T> {
 	}
 };
 
+/// ʱɴɶεout_points
+template<typename T>
+struct Placement {
+	int id;            // αţе±
+	Point<T> lb_point; // ο
+	Rotation rotation; // תǶ
+};
+
 template<typename T>
 struct SkyLineNode {
 	T x, y;
@@ -602,6 +628,8 @@ struct SkyLineNode {
 
 using point_t = Point<coord_t>;
 
+using point_slice_t = PointSlice<coord_t>;
+
 using segment_t = Segment<coord_t>;
 
 using polygon_t = Polygon<coord_t>;
@@ -624,6 +652,8 @@ using tshape_ptr = std::shared_ptr<tshape_t>;
 
 using concave_ptr = std::shared_ptr<concave_t>;
 
+using placement_t = Placement<coord_t>;
+
 using skylinenode_t = SkyLineNode<coord_t>;
 
 using skyline_t = std::vector<skylinenode_t>;
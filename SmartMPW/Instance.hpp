@@ -5,32 +5,37 @@
 #ifndef SMARTMPW_INSTANCE_HPP
 #define SMARTMPW_INSTANCE_HPP
 
+#include <cstring>
 #include <iostream>
-#include <list>
 #include <string>
 #include <fstream>
 
 #include "Data.hpp"
 #include "Utils.hpp"
+#include "PolygonFile.hpp"
 
 using namespace std;
 
 class Environment {
 public:
-	Environment(const string &ins_str) : _ins_path(ins_str) { utils::split_filename(_ins_path, _ins_dir, _ins_name, _ins_id); }
+	Environment(const string &ins_str) : _ins_path(ins_str), _binary(polygon_file::has_binary_extension(ins_str)) {
+		utils::split_filename(_ins_path, _ins_dir, _ins_name, _ins_id);
+	}
 
 #ifndef SUBMIT
 public:
 	const string& instance_name() const { return _ins_name; }
-	string instance_path() const { return instance_dir() + _ins_name + ".txt"; }
-	string solution_path() const { return solution_dir() + _ins_name + ".txt"; }
-	string solution_path_with_time() const { return solution_dir() + _ins_name + "." + utils::Date::to_long_str() + ".txt"; }
+	// .binָдƸʽͽ
+	string instance_path() const { return instance_dir() + _ins_name + extension(); }
+	string solution_path() const { return solution_dir() + _ins_name + extension(); }
+	string solution_path_with_time() const { return solution_dir() + _ins_name + "." + utils::Date::to_long_str() + extension(); }
 	string ins_html_path() const { return instance_dir() + _ins_name + ".html"; }
 	string sol_html_path() const { return solution_dir() + _ins_name + ".html"; }
 	string sol_html_path_with_time() const { return solution_dir() + _ins_name + "." + utils::Date::to_long_str() + ".html"; }
 	string log_path() const { return solution_dir() + "log.csv"; }
 	string characteristic_path() const { return instance_dir() + "characteristic.csv"; }
 private:
+	string extension() const { return _binary ? ".bin" : ".txt"; }
 	static string instance_dir() { return "Instance/"; }
 	static string solution_dir() { return "Solution/"; }
 #else
@@ -47,6 +52,7 @@ private:
 	string _ins_dir;
 	string _ins_name;
 	string _ins_id;
+	bool _binary;
 };
 
 class Instance {
@@ -70,95 +76,147 @@ public:
 
 	const vector<polygon_ptr>& get_polygon_ptrs()  const { return _polygon_ptrs; }
 
+	/// ļ޷򿪡ʽûжΣʱʵΪգӦ
+	bool load_failed() const { return _load_failed; }
+
 	// [todo] ԤϲL/Tɾ
 	void pre_combine() {}
 
 private:
+	/// ӳļѡƻıʽʱλòѶ
 	void read_instance() {
-		ifstream ifs(_env.instance_path());
-		if (!ifs.is_open()) {
+		_polygon_num = _rect_num = _lshape_num = _tshape_num = _concave_num = 0;
+		_total_area = 0;
+		_load_failed = true;
+
+		utils::MappedFile file(_env.instance_path());
+		if (!file.is_open()) {
 			cerr << "Error instance path: can not open " << _env.instance_path() << endl;
 			return;
 		}
+		bool parsed = polygon_file::is_binary(file.data(), file.size()) ? read_binary_instance(file) : read_text_instance(file);
+		if (!parsed) { return; }
+		if (_polygon_num == 0) {
+			cerr << "Error instance: no polygon in " << _env.instance_path() << endl;
+			return;
+		}
+		_load_failed = false;
+	}
 
-		_polygon_num = _rect_num = _lshape_num = _tshape_num = _concave_num = 0;
-		_total_area = 0;
-		string line;
-		while (getline(ifs, line)) {
-			if (line.front() != '(') { continue; }
-
-			stringstream ss(line);
-			char l_bracket, comma, r_bracket;
-			coord_t x, y;
-			vector<point_t> in_points;
-			while (ss >> l_bracket >> x >> comma >> y >> r_bracket) {
-				assert(l_bracket == '(' && comma == ',' && r_bracket == ')');
-				in_points.emplace_back(x, y);
+	/// ɨ裬'('ͷΪһεУ׷ӵ
+	bool read_text_instance(const utils::MappedFile &file) {
+		const char *begin = file.data(), *end = begin + file.size();
+		auto points = make_shared<vector<point_t>>();
+		points->reserve(file.size() / 8); // ÿ"(x,y)"ͨ8ַ
+		vector<segment_t> in_segments; in_segments.reserve(8);
+		int line_no = 1;
+		for (const char *line = begin; line < end; ++line_no) {
+			const char *line_end = static_cast<const char *>(memchr(line, '\n', end - line));
+			if (!line_end) { line_end = end; }
+			if (*line == '(') {
+				size_t first = points->size();
+				const char *error_pos = line;
+				const char *error = polygon_file::TextScanner::append_points(error_pos, line_end, *points);
+				if (!error) { // ״󱨸
+					error_pos = line;
+					error = add_polygon(point_slice_t(points, first, points->size()), in_segments);
+				}
+				if (error) {
+					cerr << "Error instance format: " << _env.instance_path() << ":" << line_no << ":"
+						<< error_pos - line + 1 << ": " << error << endl;
+					clear();
+					return false;
+				}
 			}
+			line = line_end + 1;
+		}
+		return true;
+	}
 
-			vector<segment_t> in_segments = transform_points_to_segments(in_points);
-
-			switch (in_segments.size()) {
-			case 4: {
-				//_polygon_ptrs.emplace_back(make_shared<rect_t>(_polygon_num++, in_points, in_segments));
-				//_rects.push_back(*dynamic_pointer_cast<rect_t>(_polygon_ptrs.back()));
-				_rects.emplace_back(_polygon_num++, in_points, in_segments);
-				_polygon_ptrs.emplace_back(make_shared<rect_t>(_rects.back()));
-				_total_area += _rects.back().area;
-				_rect_num++;
-				break;
-			}
-			case 6: {
-				//_polygon_ptrs.emplace_back(make_shared<lshape_t>(_polygon_num++, in_points, in_segments));
-				//_lshapes.push_back(*dynamic_pointer_cast<lshape_t>(_polygon_ptrs.back()));
-				_lshapes.emplace_back(_polygon_num++, in_points, in_segments);
-				_polygon_ptrs.emplace_back(make_shared<lshape_t>(_lshapes.back()));
-				_total_area += _lshapes.back().area;
-				_lshape_num++;
-				break;
+	/// ӳڴתһΣΰƫã״԰ʶǩ˶
+	bool read_binary_instance(const utils::MappedFile &file) {
+		polygon_file::View view;
+		if (const char *error = view.open(file.data(), file.size(), polygon_file::Kind::Instance)) {
+			cerr << "Error instance format: " << _env.instance_path() << ": " << error << endl;
+			return false;
+		}
+		auto points = make_shared<vector<point_t>>();
+		points->reserve(view.point_num());
+		const polygon_file::XY *coords = view.points(0);
+		for (size_t j = 0; j < view.point_num(); ++j) { points->emplace_back(coords[j].x, coords[j].y); }
+		vector<segment_t> in_segments; in_segments.reserve(8);
+		for (size_t i = 0; i < view.record_num(); ++i) {
+			size_t first = view.point_offset(i);
+			const char *error = add_polygon(point_slice_t(points, first, first + view.point_num(i)), in_segments);
+			if (!error && static_cast<uint8_t>(_polygon_ptrs.back()->shape()) != view.tag(i)) { error = "shape tag does not match the points"; }
+			if (error) {
+				cerr << "Error instance format: " << _env.instance_path() << ": polygon " << i << ": " << error << endl;
+				clear();
+				return false;
 			}
-			case 8: {
-				switch (get_shape_from_segments(in_segments)) {
-				case Shape::T: {
-					//_polygon_ptrs.emplace_back(make_shared<tshape_t>(_polygon_num++, in_points, in_segments));
-					//_tshapes.push_back(*dynamic_pointer_cast<tshape_t>(_polygon_ptrs.back()));
-					_tshapes.emplace_back(_polygon_num++, in_points, in_segments);
-					_polygon_ptrs.emplace_back(make_shared<tshape_t>(_tshapes.back()));
-					_total_area += _tshapes.back().area;
-					_tshape_num++;
-					break;
-				}
-				case Shape::C: {
-					//_polygon_ptrs.emplace_back(make_shared<concave_t>(_polygon_num++, in_points, in_segments));
-					//_concaves.push_back(*dynamic_pointer_cast<concave_t>(_polygon_ptrs.back()));
-					_concaves.emplace_back(_polygon_num++, in_points, in_segments);
-					_polygon_ptrs.emplace_back(make_shared<concave_t>(_concaves.back()));
-					_total_area += _concaves.back().area;
-					_concave_num++;
-					break;
-				}
-				default: { assert(false); break; }
-				}
-				break;
+		}
+		return true;
+	}
+
+	/// ڶ빲xy꣬޷segment_t
+	static bool is_rectilinear(const point_slice_t &points) {
+		for (size_t i = 0; i < points.size(); ++i) {
+			const point_t &a = points[i], &b = points[(i + 1) % points.size()];
+			if ((a.x == b.x) == (a.y == b.y)) { return false; }
+		}
+		return true;
+	}
+
+	/// תʶ״ʵ޷ʶʱش
+	/// ֱӹڹָУõض
+	const char *add_polygon(const point_slice_t &in_points, vector<segment_t> &in_segments) {
+		if (!is_rectilinear(in_points)) { return "polygon edges must be axis-parallel"; }
+		transform_points_to_segments(in_points, in_segments);
+		switch (in_segments.size()) {
+		case 4: {
+			_polygon_ptrs.emplace_back(make_shared<rect_t>(_polygon_num++, in_points, in_segments));
+			_rect_num++;
+			break;
+		}
+		case 6: {
+			_polygon_ptrs.emplace_back(make_shared<lshape_t>(_polygon_num++, in_points, in_segments));
+			_lshape_num++;
+			break;
+		}
+		case 8: {
+			Shape shape;
+			if (!get_shape_from_segments(in_segments, shape)) { return "8-segment polygon is neither T nor U shaped"; }
+			if (shape == Shape::T) {
+				_polygon_ptrs.emplace_back(make_shared<tshape_t>(_polygon_num++, in_points, in_segments));
+				_tshape_num++;
 			}
-			default:
-				cerr << "Error Shape: has " << in_segments.size() << " segments." << endl;
-				assert(false);
-				break;
+			else {
+				_polygon_ptrs.emplace_back(make_shared<concave_t>(_polygon_num++, in_points, in_segments));
+				_concave_num++;
 			}
+			break;
 		}
+		default:
+			return "polygon must have 4, 6 or 8 segments";
+		}
+		_total_area += _polygon_ptrs.back()->area;
+		return nullptr;
+	}
+
+	void clear() {
+		_polygon_ptrs.clear();
+		_polygon_num = _rect_num = _lshape_num = _tshape_num = _concave_num = 0;
+		_total_area = 0;
 	}
 
 	// [todo] ظ͹ߵ
-	vector<segment_t> transform_points_to_segments(const vector<point_t> &points) {
-		vector<segment_t> segments;
-		segments.reserve(8);
+	static void transform_points_to_segments(const point_slice_t &points, vector<segment_t> &segments) {
+		segments.clear();
 		for (size_t i = 0; i < points.size(); ++i)
 			segments.emplace_back(points[i], points[(i + 1) % points.size()]);
-		return segments;
 	}
 
-	Shape get_shape_from_segments(const vector<segment_t> &segments) {
+	static bool get_shape_from_segments(const vector<segment_t> &segments, Shape &shape) {
 		int turn_count = 0;
 		Direction curr_turn = segments.back().next_turn(segments.front());
 		for (size_t i = 0; i < segments.size(); ++i) {
@@ -168,19 +226,15 @@ private:
 				curr_turn = next_turn;
 			}
 		}
-		if (turn_count == 4) return Shape::T;
-		else assert(turn_count == 2); return Shape::C;
+		if (turn_count == 4) { shape = Shape::T; return true; }
+		if (turn_count == 2) { shape = Shape::C; return true; }
+		return false;
 	}
 
 private:
 	const Environment &_env;
 
-	vector<polygon_ptr> _polygon_ptrs;
-
-	list<rect_t> _rects;
-	list<lshape_t> _lshapes;
-	list<tshape_t> _tshapes;
-	list<concave_t> _concaves;
+	vector<polygon_ptr> _polygon_ptrs; // 깲ͬһ
 
 	coord_t _total_area;
 	int _polygon_num;
@@ -188,6 +242,7 @@ private:
 	int _lshape_num;
 	int _tshape_num;
 	int _concave_num;
+	bool _load_failed;
 };
 
 #endif // SMARTMPW_INSTANCE_HPP
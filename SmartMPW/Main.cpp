@@ -2,13 +2,11 @@
 //
 
 #include <cstring>
+#include <limits>
 #include "AdaptSelect.hpp"
 #include "RandomCase.hpp"
 
-void run_single_instance(const string& ins_str) {
-	Environment env(ins_str);
-	AdaptSelect asa(env, cfg);
-	asa.run();
+void record_results(const Environment& env, const AdaptSelect& asa) {
 	asa.record_sol(env.solution_path());
 
 #ifndef SUBMIT
@@ -21,7 +19,82 @@ void run_single_instance(const string& ins_str) {
 #endif // !SUBMIT
 }
 
-void run_all_instances() {
+/// 实例读取失败时不输出结果，返回false
+bool run_single_instance(const string& ins_str) {
+	Environment env(ins_str);
+	AdaptSelect asa(env, cfg);
+	asa.run();
+	if (asa.load_failed()) { return false; }
+	record_results(env, asa);
+	return true;
+}
+
+/// 批量求解：每个算例单线程求解，算例之间在线程池上并行，完成一个即输出一个。
+/// 读取失败的算例被跳过，此时返回false
+bool run_batch(const vector<pair<string, int>>& batch) {
+	ThreadPool pool(max(cfg.thread_num, 1u) - 1);
+	TaskGroup group(pool);
+	mutex output_mtx; // 保护结果文件、log.csv和标准输出
+	bool all_loaded = true;
+	for (auto& ins : batch) {
+		group.run([&ins, &output_mtx, &all_loaded]() {
+			Environment env(ins.first);
+			Config ins_cfg = cfg;
+			ins_cfg.thread_num = 1;
+			ins_cfg.ub_asa_time = ins.second;
+			AdaptSelect asa(env, ins_cfg);
+			asa.run();
+			lock_guard<mutex> guard(output_mtx);
+			if (asa.load_failed()) {
+				all_loaded = false;
+				cerr << "skip instance " << ins.first << endl;
+				return;
+			}
+			record_results(env, asa);
+			cout << "finish instance " << ins.first << " obj_area " << asa.get_obj_area() << endl;
+		});
+	}
+	group.wait();
+	return all_loaded;
+}
+
+/// 解析正整数的超时时间（秒），格式错误、不为正或超出int范围时返回false
+bool parse_seconds(const string& str, int& seconds) {
+	char* end;
+	long value = strtol(str.c_str(), &end, 10);
+	if (end == str.c_str() || *end != '\0' || value <= 0 || value > numeric_limits<int>::max()) { return false; }
+	seconds = static_cast<int>(value);
+	return true;
+}
+
+/// 清单每行一个算例，可在其后指定该算例的超时时间（秒），空行和以#开头的行被忽略
+bool run_manifest(const string& manifest_path) {
+	ifstream ifs(manifest_path);
+	if (!ifs.is_open()) {
+		cerr << "Error manifest path: can not open " << manifest_path << endl;
+		return false;
+	}
+	vector<pair<string, int>> batch;
+	bool all_valid = true; // 非法行跳过，其余算例照常运行，最终仍报告失败
+	string line;
+	for (int line_no = 1; getline(ifs, line); ++line_no) {
+		stringstream ss(line);
+		string ins;
+		if (!(ss >> ins) || ins.front() == '#') { continue; }
+		int seconds = cfg.ub_asa_time;
+		string budget;
+		if (ss >> budget && !parse_seconds(budget, seconds)) {
+			cerr << "Error manifest line " << line_no << ": invalid time budget '" << budget << "'" << endl;
+			all_valid = false;
+			continue;
+		}
+		batch.emplace_back(ins, seconds);
+	}
+	bool ok = run_batch(batch);
+	return ok && all_valid;
+}
+
+bool run_all_instances() {
 	const char* ins_list[]{
 		"polygon_area_etc_input_1",
 		"polygon_area_etc_input_2",
@@ -37,21 +110,19 @@ void run_all_instances() {
 		//"ami49_lt_Xu_1",
 		//"ami49_lt_Xu_2"
 	};
-	for (auto ins : ins_list) {
-		cout << "load instance " << ins << endl;
-		run_single_instance(ins);
-	}
+	vector<pair<string, int>> batch;
+	for (auto ins : ins_list) { batch.emplace_back(ins, cfg.ub_asa_time); }
 
 	unordered_map<Shape, string> mp{ {Shape::L, "L"}, {Shape::T, "T"}, {Shape::C, "U"} };
 	for (int s = 1; s <= 3; ++s) {
 		for (int n = 200; n <= 1000; n += 200) {
 			for (int r = 0; r <= 80; r += 20) {
 				string ins = mp[Shape(s)] + "n" + to_string(n) + "r" + to_string(r);
-				cout << "load instance " << ins << endl;
-				run_single_instance(ins);
+				batch.emplace_back(ins, cfg.ub_asa_time);
 			}
 		}
 	}
+	return run_batch(batch);
 }
 
 void create_random_cases() {
@@ -66,18 +137,36 @@ void create_random_cases() {
 
 int main(int argc, char* argv[]) {
 
-	if (argc != 2) {
-		cerr << "Error parameter. See 'placement.exe /xxx/xxx/input_<id>.txt'." << endl;
+#ifdef GENERATOR
+	create_random_cases();
+	return 0;
+#endif // GENERATOR
+
+	if (argc == 4 && strcmp(argv[1], "--convert") == 0) { // 文本与二进制格式互转，方向由源文件内容决定
+		return polygon_file::convert(argv[2], argv[3]) ? 0 : 1;
+	}
+
+	bool batch = argc >= 2 && strcmp(argv[1], "--batch") == 0;
+	int arg_num = batch ? 3 : 2; // 不含可选超时时间的参数个数
+	if (argc != arg_num && argc != arg_num + 1) {
+		cerr << "Error parameter. See 'placement.exe /xxx/xxx/input_<id>.txt [seconds]', 'placement.exe --batch manifest.txt [seconds]' or 'placement.exe --convert src dst'." << endl;
+		return 0;
+	}
+	if (argc == arg_num + 1 && !parse_seconds(argv[arg_num], cfg.ub_asa_time)) { // 覆盖ASA超时时间
+		cerr << "Error parameter: invalid time budget '" << argv[arg_num] << "'" << endl;
+		return 1;
+	}
+	bool ok;
+	if (batch) {
+		ok = run_manifest(argv[2]);
 	}
 	else if (strcmp(argv[1], "--all") == 0) {
 		cout << "Run all instances..." << endl;
-		run_all_instances();
+		ok = run_all_instances();
 	}
 	else {
-		run_single_instance(argv[1]);
+		ok = run_single_instance(argv[1]);
 	}
 
-	//create_random_cases();
-
-	return 0;
+	return ok ? 0 : 1;
 }
@@ -5,17 +5,254 @@
 #ifndef SMARTMPW_MPWBINPACK_HPP
 #define SMARTMPW_MPWBINPACK_HPP
 
-#include <list>
-#include <string>
-#include <unordered_set>
+#include <cstdint>
 #include <numeric>
 #include <algorithm>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
 
 #include "Data.hpp"
+#include "ThreadPool.hpp"
+#include "Utils.hpp"
 
 namespace mbp {
 
 	using namespace std;
+	using namespace utils;
+
+	/// δöμϣλô洢λͼ˳ɾΪO(1)
+	/// СռÿȷּάۻλͼֻܷȵĶ
+	class PolygonSet {
+	public:
+		class const_iterator {
+		public:
+			const_iterator(const PolygonSet &set, const uint64_t *mask, size_t word) : _set(set), _mask(mask), _word(word), _bits(0) {
+				if (_word < _set._bits.size()) { _bits = load(_word); skip_empty(); }
+			}
+
+			size_t operator*() const { return _set._sequence[(_word << 6) + lowest_bit(_bits)]; }
+
+			const_iterator &operator++() { _bits &= _bits - 1; skip_empty(); return *this; }
+
+			bool operator!=(const const_iterator &rhs) const { return _word != rhs._word || _bits != rhs._bits; }
+
+		private:
+			uint64_t load(size_t word) const { return _mask ? _set._bits[word] & _mask[word] : _set._bits[word]; }
+
+			void skip_empty() {
+				while (!_bits && ++_word < _set._bits.size()) { _bits = load(_word); }
+			}
+
+			const PolygonSet &_set;
+			const uint64_t *_mask;
+			size_t _word;
+			uint64_t _bits;
+		};
+
+		/// ܷĳһȵδö
+		class FitRange {
+		public:
+			FitRange(const PolygonSet &set, const uint64_t *mask) : _set(set), _mask(mask) {}
+
+			const_iterator begin() const { return const_iterator(_set, _mask, 0); }
+
+			const_iterator end() const { return const_iterator(_set, _mask, _set._bits.size()); }
+
+		private:
+			const PolygonSet &_set;
+			const uint64_t *_mask;
+		};
+
+		/// øηskylineС
+		void set_min_widths(const vector<coord_t> &min_widths) {
+			_levels = min_widths;
+			sort(_levels.begin(), _levels.end());
+			_levels.erase(unique(_levels.begin(), _levels.end()), _levels.end());
+			_polygon_levels.resize(min_widths.size());
+			for (size_t p = 0; p < min_widths.size(); ++p) {
+				_polygon_levels[p] = upper_bound(_levels.begin(), _levels.end(), min_widths[p]) - _levels.begin();
+			}
+		}
+
+		void assign(const vector<size_t> &sequence) {
+			_sequence = sequence;
+			_positions.resize(sequence.size());
+			for (size_t k = 0; k < sequence.size(); ++k) { _positions[sequence[k]] = k; }
+			size_t word_num = (sequence.size() + 63) >> 6;
+			_bits.assign(word_num, ~uint64_t(0));
+			if (sequence.size() & 63) { _bits.back() = (uint64_t(1) << (sequence.size() & 63)) - 1; }
+			_size = sequence.size();
+
+			// lλͼСȲ_levels[l-1]ĶΣ0Ϊ
+			_level_masks.assign((_levels.size() + 1) * word_num, 0);
+			if (_polygon_levels.empty()) { return; }
+			for (size_t k = 0; k < sequence.size(); ++k) {
+				_level_masks[_polygon_levels[sequence[k]] * word_num + (k >> 6)] |= uint64_t(1) << (k & 63);
+			}
+			for (size_t l = 1; l <= _levels.size(); ++l) {
+				for (size_t w = 0; w < word_num; ++w) { _level_masks[l * word_num + w] |= _level_masks[(l - 1) * word_num + w]; }
+			}
+		}
+
+		void erase(size_t polygon) {
+			size_t pos = _positions[polygon];
+			_bits[pos >> 6] &= ~(uint64_t(1) << (pos & 63));
+			--_size;
+		}
+
+		bool empty() const { return _size == 0; }
+
+		size_t size() const { return _size; }
+
+		const_iterator begin() const { return const_iterator(*this, nullptr, 0); }
+
+		const_iterator end() const { return const_iterator(*this, nullptr, _bits.size()); }
+
+		/// СȲwidthδöΣȵset_min_widths
+		FitRange fit(coord_t width) const {
+			size_t level = upper_bound(_levels.begin(), _levels.end(), width) - _levels.begin();
+			return FitRange(*this, _level_masks.data() + level * _bits.size());
+		}
+
+	private:
+		static int lowest_bit(uint64_t bits) {
+		#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, bits);
+			return static_cast<int>(index);
+		#else
+			return __builtin_ctzll(bits);
+		#endif
+		}
+
+		vector<size_t> _sequence;  // 
+		vector<size_t> _positions; // еλ
+		vector<uint64_t> _bits;    // kλʾеkδ
+		size_t _size = 0;
+
+		vector<coord_t> _levels;        // еĲͬС
+		vector<size_t> _polygon_levels; // Сڵļ𣬴1ʼ
+		vector<uint64_t> _level_masks;  // ۻλͼ
+	};
+
+	/// ͬһskylineϴֵһΣ߰SoAţһתĵ÷֡
+	/// ÷ֹMpwBinPack::score_rect_for_skyline_bottom_leftͬԭ÷ֽжϣ
+	/// ˵÷ּ߷֣ñȽϺͻָ޷֧ؼ
+	class RectBlock {
+	public:
+		void clear() { _polygons.clear(); _slots.clear(); _widths.clear(); _heights.clear(); }
+
+		bool empty() const { return _polygons.empty(); }
+
+		size_t size() const { return _polygons.size(); }
+
+		void add(size_t polygon, size_t slot, coord_t width, coord_t height) {
+			_polygons.push_back(polygon);
+			_slots.push_back(slot);
+			_widths.push_back(width);
+			_heights.push_back(height);
+		}
+
+		size_t polygon(size_t i) const { return _polygons[i]; }
+
+		size_t slot(size_t i) const { return _slots[i]; }
+
+		coord_t width(size_t i, bool rotate) const { return rotate ? _heights[i] : _widths[i]; }
+
+		/// iεĵ÷֣-1ʾŲ
+		int score(size_t i, bool rotate) const { return rotate ? _scores_90[i] : _scores_0[i]; }
+
+		/// ԿΪspace_widthҸ߶ȲΪhlhrĿռ
+		void score(coord_t space_width, coord_t hl, coord_t hr) {
+			size_t n = _polygons.size(), i = 0;
+			_scores_0.resize(n);
+			_scores_90.resize(n);
+			int32_t hi = max(hl, hr), lo = min(hl, hr);
+		#if defined(__AVX2__)
+			const __m256i sw8 = _mm256_set1_epi32(space_width), hi8 = _mm256_set1_epi32(hi), lo8 = _mm256_set1_epi32(lo);
+			for (; i + 8 <= n; i += 8) {
+				__m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_widths.data() + i));
+				__m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(_heights.data() + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(_scores_0.data() + i), score_x8(w, h, sw8, hi8, lo8));
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(_scores_90.data() + i), score_x8(h, w, sw8, hi8, lo8));
+			}
+		#endif
+		#if defined(__SSE4_1__)
+			const __m128i sw4 = _mm_set1_epi32(space_width), hi4 = _mm_set1_epi32(hi), lo4 = _mm_set1_epi32(lo);
+			for (; i + 4 <= n; i += 4) {
+				__m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_widths.data() + i));
+				__m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(_heights.data() + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(_scores_0.data() + i), score_x4(w, h, sw4, hi4, lo4));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(_scores_90.data() + i), score_x4(h, w, sw4, hi4, lo4));
+			}
+		#endif
+			for (; i < n; ++i) {
+				_scores_0[i] = score_x1(_widths[i], _heights[i], space_width, hi, lo);
+				_scores_90[i] = score_x1(_heights[i], _widths[i], space_width, hi, lo);
+			}
+		}
+
+	private:
+		/// hiloΪҸ߶ȲеĽϴߺͽС
+		static int32_t score_x1(int32_t w, int32_t h, int32_t sw, int32_t hi, int32_t lo) {
+			if (w > sw) { return -1; }
+			if (w == sw) { return h == hi ? 7 : h == lo ? 6 : h > hi ? 5 : h > lo ? 3 : 1; }
+			return h == hi ? 4 : h == lo ? 2 : 0;
+		}
+
+	#if defined(__AVX2__)
+		/// ÷ϣ
+		static __m256i score_x8(__m256i w, __m256i h, __m256i sw, __m256i hi, __m256i lo) {
+			__m256i eq_w = _mm256_cmpeq_epi32(w, sw), lt_w = _mm256_cmpgt_epi32(sw, w);
+			__m256i eq_hi = _mm256_cmpeq_epi32(h, hi), eq_lo = _mm256_cmpeq_epi32(h, lo);
+			__m256i s = _mm256_set1_epi32(-1);
+			s = _mm256_blendv_epi8(s, _mm256_set1_epi32(0), _mm256_andnot_si256(eq_hi, lt_w));
+			s = _mm256_blendv_epi8(s, _mm256_set1_epi32(1), _mm256_and_si256(eq_w, _mm256_cmpgt_epi32(lo, h)));
+			s = _mm256_blendv_epi8(s, _mm256_set1_epi32(2), _mm256_and_si256(lt_w, eq_lo));
+			s = _mm256_blendv_epi8(s, _mm256_set1_epi32(3), _mm256_and_si256(eq_w, _mm256_and_si256(_mm256_cmpgt_epi32(h, lo), _mm256_cmpgt_epi32(hi, h))));
+			s = _mm256_blendv_epi8(s, _mm256_set1_epi32(4), _mm256_and_si256(lt_w, eq_hi));
+			s = _mm256_blendv_epi8(s, _mm256_set1_epi32(5), _mm256_and_si256(eq_w, _mm256_cmpgt_epi32(h, hi)));
+			s = _mm256_blendv_epi8(s, _mm256_set1_epi32(6), _mm256_and_si256(eq_w, eq_lo));
+			return _mm256_blendv_epi8(s, _mm256_set1_epi32(7), _mm256_and_si256(eq_w, eq_hi));
+		}
+	#endif
+
+	#if defined(__SSE4_1__)
+		static __m128i score_x4(__m128i w, __m128i h, __m128i sw, __m128i hi, __m128i lo) {
+			__m128i eq_w = _mm_cmpeq_epi32(w, sw), lt_w = _mm_cmpgt_epi32(sw, w);
+			__m128i eq_hi = _mm_cmpeq_epi32(h, hi), eq_lo = _mm_cmpeq_epi32(h, lo);
+			__m128i s = _mm_set1_epi32(-1);
+			s = _mm_blendv_epi8(s, _mm_set1_epi32(0), _mm_andnot_si128(eq_hi, lt_w));
+			s = _mm_blendv_epi8(s, _mm_set1_epi32(1), _mm_and_si128(eq_w, _mm_cmpgt_epi32(lo, h)));
+			s = _mm_blendv_epi8(s, _mm_set1_epi32(2), _mm_and_si128(lt_w, eq_lo));
+			s = _mm_blendv_epi8(s, _mm_set1_epi32(3), _mm_and_si128(eq_w, _mm_and_si128(_mm_cmpgt_epi32(h, lo), _mm_cmpgt_epi32(hi, h))));
+			s = _mm_blendv_epi8(s, _mm_set1_epi32(4), _mm_and_si128(lt_w, eq_hi));
+			s = _mm_blendv_epi8(s, _mm_set1_epi32(5), _mm_and_si128(eq_w, _mm_cmpgt_epi32(h, hi)));
+			s = _mm_blendv_epi8(s, _mm_set1_epi32(6), _mm_and_si128(eq_w, eq_lo));
+			return _mm_blendv_epi8(s, _mm_set1_epi32(7), _mm_and_si128(eq_w, eq_hi));
+		}
+	#endif
+
+		vector<size_t> _polygons; // ±
+		vector<size_t> _slots;    // ںѡбеռλ±
+		vector<int32_t> _widths;
+		vector<int32_t> _heights;
+		vector<int32_t> _scores_0;
+		vector<int32_t> _scores_90;
+	};
+
+	/// ʵ״ϣsλʾ״s
+	using ShapeSet = unsigned;
+
+	constexpr ShapeSet shape_bit(Shape shape) { return 1u << shape; }
+
+	constexpr bool has_shape(ShapeSet shapes, Shape shape) { return shapes & shape_bit(shape); }
+
+	constexpr ShapeSet ALL_SHAPES = shape_bit(Shape::R) | shape_bit(Shape::L) | shape_bit(Shape::T) | shape_bit(Shape::C);
 
 	class MpwBinPack {
 
@@ -23,36 +260,236 @@ namespace mbp {
 		struct SortRule {
 			vector<size_t> sequence;
 			coord_t target_area;
+			uint64_t tabu_key; // sequenceZobristϣʱO(1)
+
+			/// λposϷöpolygonZobristsplitmix64ʱɣn*n
+			static uint64_t zobrist_key(size_t pos, size_t polygon) {
+				uint64_t z = (static_cast<uint64_t>(pos) << 32 | polygon) + 0x9e3779b97f4a7c15;
+				z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+				z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+				return z ^ (z >> 31);
+			}
 
-			string tabu_key_str() const {
-				string key = to_string(sequence.front());
-				for (size_t i = 1; i < sequence.size(); ++i) { key += "," + to_string(sequence[i]); }
-				return key;
+			void update_tabu_key() {
+				tabu_key = 0;
+				for (size_t k = 0; k < sequence.size(); ++k) { tabu_key ^= zobrist_key(k, sequence[k]); }
 			}
 
-			size_t tabu_key_hash() const { return hash<string>{}(tabu_key_str()); }
+			void swap_polygons(size_t a, size_t b) {
+				tabu_key ^= zobrist_key(a, sequence[a]) ^ zobrist_key(b, sequence[b]);
+				swap(sequence[a], sequence[b]);
+				tabu_key ^= zobrist_key(a, sequence[a]) ^ zobrist_key(b, sequence[b]);
+			}
 		};
 
-		using TabuTable = unordered_set<string>;
-		using TabuFunc = string(SortRule::*)()const;
-		TabuFunc tabu_key = &SortRule::tabu_key_str;
+		/// ɱѰַϣֻ64λʱֱmax_capacity֮̽ⴰʱʼλڴ治
+		class TabuTable {
+		public:
+			explicit TabuTable(size_t max_capacity) :
+				_slots(min(max_capacity, INITIAL_CAPACITY), EMPTY), _mask(_slots.size() - 1), _max_capacity(max_capacity) {
+				assert((max_capacity & (max_capacity - 1)) == 0); // Ϊ2
+			}
+
+			/// ڱʱfalse
+			bool insert(uint64_t key) {
+				if (key == EMPTY) { key = 1; }
+				if (2 * (_size + 1) > _slots.size() && _slots.size() < _max_capacity) { grow(); }
+				return place(key);
+			}
+
+		private:
+			bool place(uint64_t key) {
+				size_t home = static_cast<size_t>(key ^ (key >> 32)) & _mask;
+				for (size_t i = 0; i < PROBE_LENGTH; ++i) {
+					uint64_t &slot = _slots[(home + i) & _mask];
+					if (slot == key) { return false; }
+					if (slot == EMPTY) { slot = key; ++_size; return true; }
+				}
+				_slots[(home + _evict++ % PROBE_LENGTH) & _mask] = key; // ̭
+				return true;
+			}
+
+			void grow() {
+				vector<uint64_t> old_slots(_slots.size() * 2, EMPTY);
+				swap(old_slots, _slots);
+				_mask = _slots.size() - 1;
+				_size = 0;
+				for (uint64_t key : old_slots) {
+					if (key != EMPTY) { place(key); }
+				}
+			}
+
+			static constexpr uint64_t EMPTY = 0;
+			static constexpr size_t PROBE_LENGTH = 8;
+			static constexpr size_t INITIAL_CAPACITY = 1 << 8;
+
+			vector<uint64_t> _slots;
+			size_t _mask;
+			size_t _max_capacity;
+			size_t _size = 0;
+			size_t _evict = 0;
+		};
 
-		//using TabuTable = unordered_set<size_t>;
-		//using TabuFunc = size_t(SortRule::*)()const;
-		//TabuFunc tabu_key = &SortRule::tabu_key_hash;
+		/// õĶγߴ磬ֶκData.hppжӦ״ͬ
+		struct RectDims { coord_t width, height; };
+		struct LShapeDims { coord_t hd, hm, hu; coord_t vl, vm, vr; };
+		struct TShapeDims { coord_t hu, hl, hr, hd; coord_t vlu, vld, vru, vrd; };
+		using ConcaveDims = TShapeDims; // Tεıֶ߳ͬ
+
+		/// _shapesе״ǽ
+		union PolygonDims {
+			RectDims rect;
+			LShapeDims lshape;
+			TShapeDims tshape;
+			ConcaveDims concave;
+		};
+
+		/// ֺѡĳһܷµĶμ÷
+		struct Candidate {
+			size_t polygon;
+			size_t delta;  // LTCskyline.size()仯
+			coord_t waste; // L˷
+			int score;     // Rĵ÷
+		};
+
+		/// ֹеĵǰ
+		struct PickState {
+			int rect_score = -1;
+			int ltc_delta = numeric_limits<int>::max();
+			coord_t l_waste = numeric_limits<coord_t>::max();
+			size_t rect_index = NO_POLYGON, ltc_index = NO_POLYGON;
+		};
+
+		/// ù켣ÿһľߺȫѡԼڵskylineգڽ
+		struct PlacementTrace {
+			struct Step {
+				size_t polygon;          // õĶΣʱΪNO_POLYGON
+				coord_t height;          // úskyline߶
+				size_t candidate_offset; // ѡcandidatesеʼλ
+			};
+
+			struct Checkpoint {
+				size_t dst_size;         // ʱѷõĶ
+				skyline_t skyline;
+			};
+
+			vector<Step> steps;
+			vector<Candidate> candidates;
+			vector<Checkpoint> checkpoints; // iλڵi*CHECKPOINT_INTERVAL֮ǰ
+			bool complete;                  // Ƿȫ
+
+			void clear() { steps.clear(); candidates.clear(); checkpoints.clear(); complete = false; }
+		};
+
+		/// һιд״̬ʱÿеռһݣԱڼֻ
+		struct Workspace {
+			skyline_t skyline;
+			PolygonSet polygons;            // SortRulesequenceδõĶΣΪ
+			vector<Candidate> candidates;   // ¼켣ʱĺѡ
+			vector<placement_t> placements; // ʱдİڷλã±Ϊ±
+			RectBlock rect_block;           // ǰϴֵľ
+		};
+
+		/// еһ
+		struct Neighbor {
+			SortRule rule;
+			size_t a, b;    // λ
+			bool swap_move;
+			bool inserted;  // Ƿȫ
+			coord_t height;
+			vector<placement_t> dst;
+		};
+
+		/// ±ŵĶ״ͳߴ磬ʱپ麯dynamic_pointer_castͬһʵĸѡȹ
+		struct PolygonStore {
+			uint64_t id;                  // ȫΨһжϻǷ񰴱洢ʼ
+			vector<Shape> shapes;
+			vector<coord_t> areas;
+			coord_t total_area = 0;
+			vector<coord_t> max_lengths;
+			vector<PolygonDims> dims;
+			vector<coord_t> min_widths;   // skylineСο
+		};
+
+		/// һRLSʱ壬̵߳Ļãѡȳפ
+		struct Scratch {
+			uint64_t store_id = 0;          // ˴洢ʼ
+			vector<Workspace> workspaces;   // kĹworkspaces[0]ͬʱڹ׼켣
+			vector<Neighbor> neighbors;
+			PlacementTrace base_trace;      // picked_ruleķù켣
+			vector<placement_t> base_dst;   // picked_ruleķý
+			vector<size_t> base_positions;  // picked_ruleеλ
+		};
+
+		/// õǰ̻߳еһScratchʱ黹
+		/// ĵȴڼͬһ߳̿ǶִȵRLS˻ذջÿ߳һ
+		class ScratchLease {
+		public:
+			explicit ScratchLease(MpwBinPack &solver) : _solver(solver) {
+				auto &free_scratches = thread_scratches();
+				if (free_scratches.empty()) { _scratch.reset(new Scratch()); }
+				else { _scratch = move(free_scratches.back()); free_scratches.pop_back(); }
+				_solver.prepare_scratch(*_scratch);
+				_solver._scratch = _scratch.get();
+			}
+
+			~ScratchLease() {
+				_solver._scratch = nullptr;
+				thread_scratches().push_back(move(_scratch));
+			}
+
+		private:
+			static vector<unique_ptr<Scratch>> &thread_scratches() {
+				static thread_local vector<unique_ptr<Scratch>> scratches;
+				return scratches;
+			}
+
+			MpwBinPack &_solver;
+			unique_ptr<Scratch> _scratch;
+		};
+
+		static constexpr size_t NO_POLYGON = numeric_limits<size_t>::max();
+		static constexpr size_t CHECKPOINT_INTERVAL = 32;
+
+		static constexpr size_t TABU_CAPACITY = 1 << 14;
+
+		friend class MpwBinPackBenchmark; // ׼ֱӵڲĹʹֺ
 
 	public:
 
 		MpwBinPack() = delete;
 
-		MpwBinPack(const vector<polygon_ptr> &src, coord_t width, coord_t height, default_random_engine &gen) :
-			_src(src), _bin_width(width), _bin_height(height), _obj_area(numeric_limits<coord_t>::max()),
-			_gen(gen), _uniform_dist(0, _src.size() - 1) {
-			reset();
+		MpwBinPack(const vector<polygon_ptr> &src, coord_t width, coord_t height, unsigned int seed) :
+			MpwBinPack(make_polygon_store(src), make_shape_set(src), width, height, seed) {}
+
+		/// storemake_polygon_storeɣͬһʵĶ乲shapesʵеȫ״
+		/// ʱݴѡ״ػRLS״ڷںûз֧
+		MpwBinPack(shared_ptr<const PolygonStore> store, ShapeSet shapes, coord_t width, coord_t height, unsigned int seed) :
+			_bin_width(width), _bin_height(height), _obj_area(numeric_limits<coord_t>::max()), _store(move(store)),
+			_shapes(_store->shapes), _areas(_store->areas), _max_lengths(_store->max_lengths), _dims(_store->dims), _min_widths(_store->min_widths),
+			_tabu_table(TABU_CAPACITY), _pool(nullptr), _batch_size(1), _scratch(nullptr), _uniform_dist(0, _shapes.size() - 1), _gen(seed),
+			_kernels(select_kernels(shapes)) {
+			assert(all_of(_shapes.begin(), _shapes.end(), [shapes](Shape shape) { return shapes & shape_bit(shape); }));
 			init_sort_rules();
 		}
 
-		const vector<polygon_ptr> &get_dst() const { return _dst; }
+		static ShapeSet make_shape_set(const vector<polygon_ptr> &src) {
+			ShapeSet shapes = 0;
+			for (auto &ptr : src) { shapes |= shape_bit(ptr->shape()); }
+			return shapes;
+		}
+
+		/// ״ͳߴչΪ±ŵ
+		static shared_ptr<const PolygonStore> make_polygon_store(const vector<polygon_ptr> &src) {
+			static atomic<uint64_t> next_id(1);
+			shared_ptr<PolygonStore> store = make_shared<PolygonStore>();
+			store->id = next_id++;
+			init_polygon_store(*store, src);
+			init_min_widths(*store);
+			return store;
+		}
+
+		const vector<placement_t> &get_dst() const { return _dst; }
 
 		coord_t get_obj_area() const { return _obj_area; }
 
@@ -60,21 +497,24 @@ namespace mbp {
 
 		void set_bin_height(coord_t height) { _bin_height = height; } // Ͻ
 
-		coord_t get_skyline_height() const { // Űϱ߽
-			return max_element(_skyline.begin(), _skyline.end(),
-				[](const skylinenode_t &lhs, const skylinenode_t &rhs) { return lhs.y < rhs.y; })->y;
+		/// ÿbatch_sizepoolǿʱõĸĽbatch_sizeΪ1ʱͬ
+		void set_batch(ThreadPool *pool, size_t batch_size) {
+			_pool = pool;
+			_batch_size = max<size_t>(batch_size, 1);
 		}
 
-		/// bin_widthRLS
-		void random_local_search(int iter) {
+		/// bin_widthRLSdeadlineʱǰ
+		void random_local_search(int iter, const Deadline &deadline = Deadline()) {
+			ScratchLease lease(*this);
+			Workspace &ws = _scratch->workspaces[0];
 			// the first time to call RLS on W_k
 			if (iter == 1) {
 				for (auto &rule : _sort_rules) {
-					_polygons.assign(rule.sequence.begin(), rule.sequence.end());
-					vector<polygon_ptr> target_dst;
-					bool first_insert = insert_bottom_left_score(target_dst);
+					ws.polygons.assign(rule.sequence);
+					vector<placement_t> target_dst;
+					bool first_insert = insert_bottom_left_score(ws, target_dst);
 					assert(first_insert); // һαȫ
-					rule.target_area = _bin_width * get_skyline_height();
+					rule.target_area = _bin_width * get_skyline_height(ws);
 					if (rule.target_area < _obj_area) {
 						_obj_area = rule.target_area;
 						_dst = target_dst;
@@ -86,26 +526,37 @@ namespace mbp {
 			}
 			// Ż
 			SortRule &picked_rule = _sort_rules[_discrete_dist(_gen)];
-			for (int i = 1; i <= iter; ++i) {
-				SortRule new_rule = picked_rule;
-				if (iter % 4) { swap_sort_rule(new_rule); }
-				else { rotate_sort_rule(new_rule); }
-
-				//if (_tabu_table.count((new_rule.*tabu_key)())) { continue; } // ѽ
-				//_tabu_table.insert((new_rule.*tabu_key)());
-
-				_polygons.assign(new_rule.sequence.begin(), new_rule.sequence.end());
-				vector<polygon_ptr> target_dst;
-				if (!insert_bottom_left_score(target_dst)) { continue; } // Ų
-				coord_t target_height = get_skyline_height();
-				new_rule.target_area = _bin_width * target_height;
-				if (new_rule.target_area < picked_rule.target_area) {
-					picked_rule = new_rule;
+			set_base_rule(picked_rule);
+			for (int i = 1; i <= iter && !deadline.expired();) {
+				// һδɵֻڴ˴
+				size_t neighbor_num = 0;
+				for (; neighbor_num < _batch_size && i <= iter; ++i) {
+					Neighbor &neighbor = _scratch->neighbors[neighbor_num];
+					neighbor.rule = picked_rule;
+					neighbor.swap_move = i % 4; // ÿ431ת
+					if (neighbor.swap_move) { swap_sort_rule(neighbor.rule, neighbor.a, neighbor.b); }
+					else { rotate_sort_rule(neighbor.rule); }
+					if (_tabu_table.insert(neighbor.rule.tabu_key)) { ++neighbor_num; } // ѽ
+				}
+				if (neighbor_num == 0) { continue; }
+				evaluate_neighbors(neighbor_num, picked_rule.target_area);
+
+				// õĸĽͬʱȡ
+				Neighbor *best_neighbor = nullptr;
+				for (size_t k = 0; k < neighbor_num; ++k) {
+					Neighbor &neighbor = _scratch->neighbors[k];
+					if (!neighbor.inserted) { continue; } // Ų
+					neighbor.rule.target_area = _bin_width * neighbor.height;
+					if (!best_neighbor || neighbor.rule.target_area < best_neighbor->rule.target_area) { best_neighbor = &neighbor; }
+				}
+				if (best_neighbor && best_neighbor->rule.target_area < picked_rule.target_area) {
+					swap(picked_rule, best_neighbor->rule);
 					if (picked_rule.target_area < _obj_area) {
 						_obj_area = picked_rule.target_area;
-						_dst = target_dst;
-						set_bin_height(target_height);
+						_dst = best_neighbor->dst;
+						set_bin_height(best_neighbor->height);
 					}
+					set_base_rule(picked_rule);
 				}
 			}
 			// б
@@ -113,64 +564,283 @@ namespace mbp {
 				return lhs.target_area > rhs.target_area; });
 		}
 
-		/// ʹֲԣ̰Ĺһ
-		bool insert_bottom_left_score(vector<polygon_ptr> &dst) {
-			reset();
-			dst.clear(); dst.reserve(_polygons.size());
+	private:
+		/// ״ػĹںˣ״ûз֧RLS״޹أ֮
+		struct Kernels {
+			bool (MpwBinPack::*insert_remaining)(Workspace &, vector<placement_t> &, bool, coord_t);
+			bool (MpwBinPack::*insert_swapped)(Workspace &, const vector<size_t> &, size_t, size_t, vector<placement_t> &, coord_t);
+		};
+
+		template<ShapeSet Shapes>
+		static Kernels make_kernels() {
+			return { &MpwBinPack::insert_remaining_bottom_left_score<Shapes>, &MpwBinPack::insert_bottom_left_score<Shapes> };
+		}
 
-			while (!_polygons.empty()) {
-				auto bottom_skyline_iter = min_element(_skyline.begin(), _skyline.end(), [](skylinenode_t &lhs, skylinenode_t &rhs) { return lhs.y < rhs.y; });
-				auto best_skyline_index = distance(_skyline.begin(), bottom_skyline_iter);
+		/// ػֻμμһLTCϣʹúȫ״İ汾
+		static Kernels select_kernels(ShapeSet shapes) {
+			switch (shapes) {
+			case shape_bit(Shape::R): return make_kernels<shape_bit(Shape::R)>();
+			case shape_bit(Shape::R) | shape_bit(Shape::L): return make_kernels<shape_bit(Shape::R) | shape_bit(Shape::L)>();
+			case shape_bit(Shape::R) | shape_bit(Shape::T): return make_kernels<shape_bit(Shape::R) | shape_bit(Shape::T)>();
+			case shape_bit(Shape::R) | shape_bit(Shape::C): return make_kernels<shape_bit(Shape::R) | shape_bit(Shape::C)>();
+			default: return make_kernels<ALL_SHAPES>();
+			}
+		}
+
+		/// Shapesֻһ״ʱضȡ״
+		template<ShapeSet Shapes>
+		Shape shape_of(size_t polygon) const {
+			if constexpr (Shapes == shape_bit(Shape::R)) { return Shape::R; }
+			else if constexpr (Shapes == shape_bit(Shape::L)) { return Shape::L; }
+			else if constexpr (Shapes == shape_bit(Shape::T)) { return Shape::T; }
+			else if constexpr (Shapes == shape_bit(Shape::C)) { return Shape::C; }
+			else { return _shapes[polygon]; }
+		}
+
+		/// еǰneighbor_num򣬵kʹõkڼ׼켣ȳԱֻ
+		/// ߳Э±ȡTaskGroup::waitִֻб񣬵ֻ߳ȴѿʼ
+		/// Ŀܵcutoff_area򲻻ᱻܣ;
+		void evaluate_neighbors(size_t neighbor_num, coord_t cutoff_area) {
+			if (!_pool || neighbor_num == 1) {
+				for (size_t k = 0; k < neighbor_num; ++k) { evaluate_neighbor(_scratch->workspaces[k], _scratch->neighbors[k], cutoff_area); }
+				return;
+			}
+			atomic<size_t> next_neighbor(0);
+			auto evaluate = [this, &next_neighbor, neighbor_num, cutoff_area]() {
+				for (size_t k; (k = next_neighbor++) < neighbor_num;) { evaluate_neighbor(_scratch->workspaces[k], _scratch->neighbors[k], cutoff_area); }
+			};
+			TaskGroup group(*_pool);
+			for (size_t k = 1; k < min<size_t>(neighbor_num, _pool->size() + 1); ++k) { group.run(evaluate); }
+			evaluate();
+			group.wait();
+		}
 
-				polygon_ptr best_dst_node;
+		void evaluate_neighbor(Workspace &ws, Neighbor &neighbor, coord_t cutoff_area) {
+			const vector<size_t> &sequence = neighbor.rule.sequence;
+			if (neighbor.swap_move) {
+				neighbor.inserted = (this->*_kernels.insert_swapped)(ws, sequence, min(neighbor.a, neighbor.b), max(neighbor.a, neighbor.b), neighbor.dst, cutoff_area);
+			}
+			else {
+				ws.polygons.assign(sequence);
+				neighbor.inserted = insert_bottom_left_score(ws, neighbor.dst, cutoff_area);
+			}
+			if (neighbor.inserted) { neighbor.height = get_skyline_height(ws); }
+		}
+
+		/// ʹֲԣ̰Ĺһ⣻Ŀ½ﵽcutoff_areaʱfalse
+		bool insert_bottom_left_score(Workspace &ws, vector<placement_t> &dst, coord_t cutoff_area = numeric_limits<coord_t>::max()) {
+			reset(ws);
+			dst.clear(); dst.reserve(ws.polygons.size());
+			return (this->*_kernels.insert_remaining)(ws, dst, false, cutoff_area);
+		}
+
+		/// sequenceΪ׼нλa<bĽͬ
+		/// ֻҪÿһѡеĶβ䣬skylineͺѡ÷־׼켣ֻͬӰѡȺ˳
+		/// ˰˳ݼ¼ĺѡҵһ߸ıĲ裬֮ǰĿջָskyline
+		template<ShapeSet Shapes>
+		bool insert_bottom_left_score(Workspace &ws, const vector<size_t> &sequence, size_t a, size_t b, vector<placement_t> &dst, coord_t cutoff_area) {
+			const auto &steps = _scratch->base_trace.steps;
+			size_t diverge_step = 0;
+			for (; diverge_step < steps.size(); ++diverge_step) {
+				const auto &step = steps[diverge_step];
+				if (step.polygon == NO_POLYGON) { continue; } // ˳޹
+				if (repick_polygon_for_swap<Shapes>(diverge_step, sequence[a], a, sequence[b], b) != step.polygon) { break; }
+				if (step.height > _bin_height) { return false; } // _bin_height
+			}
+			if (diverge_step == steps.size() && !_scratch->base_trace.complete) { return false; }
+
+			// ָգطŵһıĲ
+			size_t checkpoint_index = min(diverge_step / CHECKPOINT_INTERVAL, _scratch->base_trace.checkpoints.size() - 1);
+			const auto &checkpoint = _scratch->base_trace.checkpoints[checkpoint_index];
+			ws.skyline = checkpoint.skyline;
+			dst.clear(); dst.reserve(sequence.size());
+			dst.assign(_scratch->base_dst.begin(), _scratch->base_dst.begin() + checkpoint.dst_size);
+			ws.polygons.assign(sequence);
+			for (size_t k = 0; k < diverge_step; ++k) {
+				if (steps[k].polygon != NO_POLYGON) { ws.polygons.erase(steps[k].polygon); }
+			}
+			for (size_t k = checkpoint_index * CHECKPOINT_INTERVAL; k < diverge_step; ++k) {
+				size_t best_skyline_index = find_bottom_skyline(ws);
+				if (steps[k].polygon == NO_POLYGON) { fill_bottom_skyline(ws, best_skyline_index); continue; }
+				const size_t replay[] = { steps[k].polygon };
 				size_t best_polygon_index;
 				coord_t best_skyline_height;
-				if (find_polygon_for_skyline_bottom_left_all(best_skyline_index, _polygons, best_dst_node, best_polygon_index, best_skyline_height)) {
-					_polygons.remove(best_polygon_index);
-					dst.push_back(best_dst_node);
+				find_polygon_for_skyline_bottom_left_all<Shapes>(ws, best_skyline_index, replay, best_polygon_index, best_skyline_height, ws.candidates);
+				ws.candidates.clear();
+				dst.push_back(_scratch->base_dst[dst.size()]); // ׼ֱͬӹ
+			}
+
+			// ʣಿ
+			return insert_remaining_bottom_left_score<Shapes>(ws, dst, false, cutoff_area);
+		}
+
+		/// ӵǰskyline_polygonsеʣΣrecordΪʱ¼׼켣
+		template<ShapeSet Shapes>
+		bool insert_remaining_bottom_left_score(Workspace &ws, vector<placement_t> &dst, bool record,
+			coord_t cutoff_area = numeric_limits<coord_t>::max()) {
+			bool bounded = cutoff_area != numeric_limits<coord_t>::max();
+			coord_t remaining_area = _store->total_area;
+			if (bounded) { for (auto &placement : dst) { remaining_area -= _areas[placement.id]; } }
+			while (!ws.polygons.empty()) {
+				if (record && _scratch->base_trace.steps.size() % CHECKPOINT_INTERVAL == 0) {
+					_scratch->base_trace.checkpoints.push_back({ dst.size(), ws.skyline });
+				}
+				size_t best_skyline_index = find_bottom_skyline(ws);
+
+				size_t best_polygon_index;
+				coord_t best_skyline_height;
+				vector<Candidate> &candidates = record ? _scratch->base_trace.candidates : ws.candidates;
+				size_t candidate_offset = candidates.size();
+				if (find_polygon_for_skyline_bottom_left_all<Shapes>(ws, best_skyline_index, ws.polygons.fit(ws.skyline[best_skyline_index].width), best_polygon_index, best_skyline_height, candidates)) {
+					ws.polygons.erase(best_polygon_index);
+					dst.push_back(ws.placements[best_polygon_index]);
+					remaining_area -= _areas[best_polygon_index];
+					if (record) { _scratch->base_trace.steps.push_back({ best_polygon_index, best_skyline_height, candidate_offset }); }
 					if (best_skyline_height > _bin_height) { return false; } // _bin_height
 				}
 				else { // 
-					if (best_skyline_index == 0) { _skyline[best_skyline_index].y = _skyline[best_skyline_index + 1].y; }
-					else if (best_skyline_index == _skyline.size() - 1) { _skyline[best_skyline_index].y = _skyline[best_skyline_index - 1].y; }
-					else { _skyline[best_skyline_index].y = min(_skyline[best_skyline_index - 1].y, _skyline[best_skyline_index + 1].y); }
-					merge_skylines(_skyline);
+					fill_bottom_skyline(ws, best_skyline_index);
+					if (record) { _scratch->base_trace.steps.push_back({ NO_POLYGON, 0, candidate_offset }); }
 				}
+				if (!record) { ws.candidates.clear(); }
+				if (bounded && lower_bound_area(ws, remaining_area) >= cutoff_area) { return false; } // ܸĽ
 			}
 
+			if (record) { _scratch->base_trace.complete = true; }
 			return true;
 		}
 
-	private:
-		void reset() {
-			_skyline.clear();
-			_skyline.push_back({ 0,0,_bin_width });
+		/// ruleΪ׼ù켣
+		void set_base_rule(const SortRule &rule) {
+			Workspace &ws = _scratch->workspaces[0];
+			_scratch->base_trace.clear();
+			ws.polygons.assign(rule.sequence);
+			reset(ws);
+			_scratch->base_dst.clear(); _scratch->base_dst.reserve(rule.sequence.size());
+			(this->*_kernels.insert_remaining)(ws, _scratch->base_dst, true, numeric_limits<coord_t>::max());
+			_scratch->base_positions.resize(rule.sequence.size());
+			for (size_t k = 0; k < rule.sequence.size(); ++k) { _scratch->base_positions[rule.sequence[k]] = k; }
+		}
+
+		/// ׼켣stepĺѡڽpaapbba<b˳¾
+		template<ShapeSet Shapes>
+		size_t repick_polygon_for_swap(size_t step, size_t pa, size_t a, size_t pb, size_t b) const {
+			const auto &steps = _scratch->base_trace.steps;
+			auto first = _scratch->base_trace.candidates.begin() + steps[step].candidate_offset;
+			auto last = step + 1 < steps.size() ? _scratch->base_trace.candidates.begin() + steps[step + 1].candidate_offset : _scratch->base_trace.candidates.end();
+
+			const Candidate *candidate_a = nullptr, *candidate_b = nullptr;
+			for (auto it = first; it != last; ++it) {
+				if (it->polygon == pa) { candidate_a = &*it; }
+				else if (it->polygon == pb) { candidate_b = &*it; }
+			}
+			if (!candidate_a && !candidate_b) { return steps[step].polygon; } // Ų£˳Ӱ
+
+			PickState state;
+			for (auto it = first; it != last; ++it) {
+				if (it->polygon == pa || it->polygon == pb) { continue; }
+				size_t pos = _scratch->base_positions[it->polygon];
+				if (pos > a && candidate_a) { offer_candidate<Shapes>(*candidate_a, state); candidate_a = nullptr; }
+				if (pos > b && candidate_b) { offer_candidate<Shapes>(*candidate_b, state); candidate_b = nullptr; }
+				offer_candidate<Shapes>(*it, state);
+			}
+			if (candidate_a) { offer_candidate<Shapes>(*candidate_a, state); }
+			if (candidate_b) { offer_candidate<Shapes>(*candidate_b, state); }
+			return pick_polygon<Shapes>(state);
+		}
+
+		coord_t get_skyline_height(const Workspace &ws) const { // Űϱ߽
+			return max_element(ws.skyline.begin(), ws.skyline.end(),
+				[](const skylinenode_t &lhs, const skylinenode_t &rhs) { return lhs.y < rhs.y; })->y;
+		}
+
+		/// ʱĿ½磺ո߶Ȳڵǰ߶Σbin_widthո߶skyline·ʣ
+		coord_t lower_bound_area(const Workspace &ws, coord_t remaining_area) const {
+			coord_t skyline_area = 0, skyline_height = 0;
+			for (auto &node : ws.skyline) {
+				skyline_area += node.width * node.y;
+				skyline_height = max(skyline_height, node.y);
+			}
+			return _bin_width * max(skyline_height, (skyline_area + remaining_area + _bin_width - 1) / _bin_width);
+		}
+
+		size_t find_bottom_skyline(const Workspace &ws) const {
+			auto bottom_skyline_iter = min_element(ws.skyline.begin(), ws.skyline.end(), [](const skylinenode_t &lhs, const skylinenode_t &rhs) { return lhs.y < rhs.y; });
+			return distance(ws.skyline.begin(), bottom_skyline_iter);
+		}
+
+		/// ӣûжܷͶʱ̧ڽϵͶεĸ߶
+		void fill_bottom_skyline(Workspace &ws, size_t best_skyline_index) const {
+			if (best_skyline_index == 0) { ws.skyline[best_skyline_index].y = ws.skyline[best_skyline_index + 1].y; }
+			else if (best_skyline_index == ws.skyline.size() - 1) { ws.skyline[best_skyline_index].y = ws.skyline[best_skyline_index - 1].y; }
+			else { ws.skyline[best_skyline_index].y = min(ws.skyline[best_skyline_index - 1].y, ws.skyline[best_skyline_index + 1].y); }
+			merge_skylines(ws.skyline, best_skyline_index, best_skyline_index + 1);
+		}
+
+		void reset(Workspace &ws) const {
+			ws.skyline.clear();
+			ws.skyline.push_back({ 0,0,_bin_width });
+		}
+
+		static void init_polygon_store(PolygonStore &store, const vector<polygon_ptr> &src) {
+			store.shapes.reserve(src.size());
+			store.areas.reserve(src.size());
+			store.dims.reserve(src.size());
+			store.max_lengths.reserve(src.size());
+			for (auto &ptr : src) {
+				PolygonDims dims;
+				switch (ptr->shape()) {
+				case Shape::R: {
+					auto rect = dynamic_pointer_cast<rect_t>(ptr);
+					dims.rect = { rect->width, rect->height };
+					break;
+				}
+				case Shape::L: {
+					auto lshape = dynamic_pointer_cast<lshape_t>(ptr);
+					dims.lshape = { lshape->hd, lshape->hm, lshape->hu, lshape->vl, lshape->vm, lshape->vr };
+					break;
+				}
+				case Shape::T: {
+					auto tshape = dynamic_pointer_cast<tshape_t>(ptr);
+					dims.tshape = { tshape->hu, tshape->hl, tshape->hr, tshape->hd, tshape->vlu, tshape->vld, tshape->vru, tshape->vrd };
+					break;
+				}
+				case Shape::C: {
+					auto concave = dynamic_pointer_cast<concave_t>(ptr);
+					dims.concave = { concave->hu, concave->hl, concave->hr, concave->hd, concave->vlu, concave->vld, concave->vru, concave->vrd };
+					break;
+				}
+				default: { assert(false); break; }
+				}
+				store.shapes.push_back(ptr->shape());
+				store.areas.push_back(ptr->area);
+				store.total_area += ptr->area;
+				store.dims.push_back(dims);
+				store.max_lengths.push_back(ptr->max_length);
+			}
 		}
 
 		void init_sort_rules() {
 			// 0_˳
-			vector<size_t> seq(_src.size());
+			vector<size_t> seq(_shapes.size());
 			iota(seq.begin(), seq.end(), 0);
 			_sort_rules.reserve(5);
-			for (size_t i = 0; i < 5; ++i) { _sort_rules.push_back({ seq, numeric_limits<coord_t>::max() }); }
-			//_tabu_table.insert((_sort_rules[0].*tabu_key)());
+			for (size_t i = 0; i < 5; ++i) { _sort_rules.push_back({ seq, numeric_limits<coord_t>::max(), 0 }); }
 			// 1_ݼ
 			sort(_sort_rules[1].sequence.begin(), _sort_rules[1].sequence.end(), [this](size_t lhs, size_t rhs) {
-				return _src.at(lhs)->area > _src.at(rhs)->area; });
-			//_tabu_table.insert((_sort_rules[1].*tabu_key)());
+				return _areas[lhs] > _areas[rhs]; });
 			// 2_ߵݼ
 			sort(_sort_rules[2].sequence.begin(), _sort_rules[2].sequence.end(), [this](size_t lhs, size_t rhs) {
-				return _src.at(lhs)->max_length > _src.at(rhs)->max_length; });
-			//_tabu_table.insert((_sort_rules[2].*tabu_key)());
+				return _max_lengths[lhs] > _max_lengths[rhs]; });
 			// 3_
 			shuffle(_sort_rules[3].sequence.begin(), _sort_rules[3].sequence.end(), _gen);
-			//_tabu_table.insert((_sort_rules[3].*tabu_key)());
 			// 4_Ѷȵݼ
 			sort(_sort_rules[4].sequence.begin(), _sort_rules[4].sequence.end(), [this](size_t lhs, size_t rhs) {
-				return _src.at(lhs)->shape() > _src.at(rhs)->shape(); });
-
-			// Ĭ˳
-			_polygons.assign(_sort_rules[0].sequence.begin(), _sort_rules[0].sequence.end());
+				return _shapes[lhs] > _shapes[rhs]; });
+			for (auto &rule : _sort_rules) {
+				rule.update_tabu_key();
+				_tabu_table.insert(rule.tabu_key);
+			}
 
 			// ɢʷֲʼ
 			vector<int> probs; probs.reserve(_sort_rules.size());
@@ -178,39 +848,77 @@ namespace mbp {
 			_discrete_dist = discrete_distribution<>(probs.begin(), probs.end());
 		}
 
+		/// һڷŷʽСskylineοȣխĶαȻŲ£ʱֱ
+		static void init_min_widths(PolygonStore &store) {
+			store.min_widths.reserve(store.shapes.size());
+			for (size_t p = 0; p < store.shapes.size(); ++p) {
+				const PolygonDims &dims = store.dims[p];
+				switch (store.shapes[p]) {
+				case Shape::R: store.min_widths.push_back(min(dims.rect.width, dims.rect.height)); break;
+				case Shape::L: store.min_widths.push_back(min({ dims.lshape.hd, dims.lshape.vl, dims.lshape.vr, dims.lshape.hu })); break;
+				case Shape::T: store.min_widths.push_back(min({ dims.tshape.hd, dims.tshape.vrd, dims.tshape.hu, dims.tshape.vld })); break;
+				case Shape::C: store.min_widths.push_back(dims.concave.hd); break;
+				default: assert(false); break;
+				}
+			}
+		}
+
+		/// Ĵ洢׼õĻ壻ͬһ洢ĹֻʼһΣskylineÿιʱ
+		void prepare_scratch(Scratch &scratch) const {
+			if (scratch.store_id != _store->id) {
+				scratch.store_id = _store->id;
+				scratch.workspaces.clear();
+			}
+			size_t old_size = scratch.workspaces.size();
+			if (old_size < _batch_size) {
+				scratch.workspaces.resize(_batch_size);
+				for (size_t k = old_size; k < _batch_size; ++k) { init_workspace(scratch.workspaces[k]); }
+			}
+			if (scratch.neighbors.size() < _batch_size) { scratch.neighbors.resize(_batch_size); }
+		}
+
+		void init_workspace(Workspace &ws) const {
+			reset(ws);
+			ws.polygons.set_min_widths(_min_widths);
+			ws.placements.clear(); ws.placements.reserve(_shapes.size());
+			for (size_t p = 0; p < _shapes.size(); ++p) { ws.placements.push_back({ static_cast<int>(p), { 0, 0 }, Rotation::_0_ }); }
+		}
+
 		/// 1˳
-		void swap_sort_rule(SortRule &rule) {
-			size_t a = _uniform_dist(_gen);
-			size_t b = _uniform_dist(_gen);
+		void swap_sort_rule(SortRule &rule, size_t &a, size_t &b) {
+			a = _uniform_dist(_gen);
+			b = _uniform_dist(_gen);
 			while (a == b) { b = _uniform_dist(_gen); }
-			swap(rule.sequence[a], rule.sequence[b]);
+			rule.swap_polygons(a, b);
 		}
 
 		/// 2ƶ
 		void rotate_sort_rule(SortRule &rule) {
 			size_t a = _uniform_dist(_gen);
 			rotate(rule.sequence.begin(), rule.sequence.begin() + a, rule.sequence.end());
+			rule.update_tabu_key(); // λö仯¼
 		}
 
 		/// ĽѡõĿ
-		bool find_polygon_for_skyline_bottom_left_partial(size_t skyline_index, const list<size_t> &polygons,
-			polygon_ptr &best_dst_node, size_t &best_polygon_index, coord_t &best_skyline_height) {
+		template<typename Polygons>
+		bool find_polygon_for_skyline_bottom_left_partial(Workspace &ws, size_t skyline_index, const Polygons &polygons,
+			size_t &best_polygon_index, coord_t &best_skyline_height) const {
 
 			int best_score = -1;
 			for (size_t p : polygons) {
-				switch (_src.at(p)->shape()) {
+				switch (_shapes[p]) {
 				case Shape::R: {
-					auto rect = dynamic_pointer_cast<rect_t>(_src.at(p));
+					const RectDims &rect = _dims[p].rect;
 					coord_t x; int score;
 					for (int rotate = 0; rotate <= 1; ++rotate) {
-						coord_t w = rect->width, h = rect->height;
+						coord_t w = rect.width, h = rect.height;
 						if (rotate) { swap(w, h); }
-						if (score_rect_for_skyline_bottom_left(skyline_index, w, h, x, score)) {
+						if (score_rect_for_skyline_bottom_left(ws, skyline_index, w, h, x, score)) {
 							if (best_score < score) {
 								best_score = score;
-								rect->lb_point.x = x;
-								rect->lb_point.y = _skyline[skyline_index].y;
-								rect->rotation = rotate ? Rotation::_90_ : Rotation::_0_;
+								ws.placements[p].lb_point.x = x;
+								ws.placements[p].lb_point.y = ws.skyline[skyline_index].y;
+								ws.placements[p].rotation = rotate ? Rotation::_90_ : Rotation::_0_;
 								best_polygon_index = p;
 							}
 						}
@@ -218,29 +926,29 @@ namespace mbp {
 					break;
 				}
 				case Shape::L: {
-					auto lshape = dynamic_pointer_cast<lshape_t>(_src.at(p));
 					coord_t waste; // no use
-					if (score_lshape_for_skyline_bottom_left(skyline_index, lshape, _skyline, best_skyline_height, waste)) {
+					SkylinePatch skyline;
+					if (score_lshape_for_skyline_bottom_left(ws, skyline_index, _dims[p].lshape, ws.placements[p], skyline, best_skyline_height, waste)) {
+						skyline.apply(ws.skyline);
 						best_polygon_index = p;
-						best_dst_node = make_shared<lshape_t>(*lshape);
 						return true; // _skylineѱ
 					}
 					break;
 				}
 				case Shape::T: {
-					auto tshape = dynamic_pointer_cast<tshape_t>(_src.at(p));
-					if (score_tshape_for_skyline_bottom_left(skyline_index, tshape, _skyline, best_skyline_height)) {
+					SkylinePatch skyline;
+					if (score_tshape_for_skyline_bottom_left(ws, skyline_index, _dims[p].tshape, ws.placements[p], skyline, best_skyline_height)) {
+						skyline.apply(ws.skyline);
 						best_polygon_index = p;
-						best_dst_node = make_shared<tshape_t>(*tshape);
 						return true; // _skylineѱ
 					}
 					break;
 				}
 				case Shape::C: {
-					auto concave = dynamic_pointer_cast<concave_t>(_src.at(p));
-					if (score_concave_for_skyline_bottom_left(skyline_index, concave, _skyline, best_skyline_height)) {
+					SkylinePatch skyline;
+					if (score_concave_for_skyline_bottom_left(ws, skyline_index, _dims[p].concave, ws.placements[p], skyline, best_skyline_height)) {
+						skyline.apply(ws.skyline);
 						best_polygon_index = p;
-						best_dst_node = make_shared<concave_t>(*concave);
 						return true; // _skylineѱ
 					}
 					break;
@@ -251,97 +959,67 @@ namespace mbp {
 
 			if (best_score == -1) { return false; }
 
-			// е˴һǾΣ`_skyline``best_skyline_height`
-			assert(_src.at(best_polygon_index)->shape() == Shape::R);
-			auto rect = dynamic_pointer_cast<rect_t>(_src.at(best_polygon_index));
-			coord_t w = rect->width, h = rect->height;
-			if (rect->rotation == Rotation::_90_) { swap(w, h); }
-			skylinenode_t new_skyline_node{ rect->lb_point.x, rect->lb_point.y + h, w };
-			if (rect->lb_point.x == _skyline[skyline_index].x) { // 
-				_skyline.insert(_skyline.begin() + skyline_index, new_skyline_node);
-				_skyline[skyline_index + 1].x += w;
-				_skyline[skyline_index + 1].width -= w;
-				merge_skylines(_skyline);
-			}
-			else { // 
-				_skyline.insert(_skyline.begin() + skyline_index + 1, new_skyline_node);
-				_skyline[skyline_index].width -= w;
-				merge_skylines(_skyline);
-			}
-			best_skyline_height = new_skyline_node.y;
-			best_dst_node = make_shared<rect_t>(*rect);
+			// е˴һǾΣ`ws.skyline``best_skyline_height`
+			assert(_shapes[best_polygon_index] == Shape::R);
+			best_skyline_height = place_rect_on_skyline(ws, skyline_index, best_polygon_index);
 			return true;
 		}
 
-		/// ĽѡõĿ
-		bool find_polygon_for_skyline_bottom_left_all(size_t skyline_index, const list<size_t> &polygons,
-			polygon_ptr &best_dst_node, size_t &best_polygon_index, coord_t &best_skyline_height) {
-
-			int best_rect_score = -1; // Rʹôֲ
-			int best_ltc_delta = numeric_limits<int>::max(); // LTCʹskyline.size()仯delta
-			coord_t best_l_waste = numeric_limits<coord_t>::max(); // LͬʱʹС˷
+		/// ĽѡõĿ飬ܷµĺѡ׷ӵcandidates
+		template<ShapeSet Shapes, typename Polygons>
+		bool find_polygon_for_skyline_bottom_left_all(Workspace &ws, size_t skyline_index, const Polygons &polygons,
+			size_t &best_polygon_index, coord_t &best_skyline_height, vector<Candidate> &candidates) const {
 
-			size_t best_rect_index, best_ltc_index;
-			skyline_t best_rect_skyline, best_ltc_skyline;
-			coord_t best_rect_height, best_ltc_height;
+			PickState state; // RʹôֲԣLTCʹskyline.size()仯deltaLͬʱʹС˷
+			SkylinePatch best_ltc_skyline;
+			coord_t best_ltc_height = 0;
+			size_t first_candidate = candidates.size();
+			ws.rect_block.clear();
 
 			for (size_t p : polygons) {
-				switch (_src.at(p)->shape()) {
-				case Shape::R: {
-					auto rect = dynamic_pointer_cast<rect_t>(_src.at(p));
-					coord_t x; int rect_score;
-					for (int rotate = 0; rotate <= 1; ++rotate) {
-						coord_t w = rect->width, h = rect->height;
-						if (rotate) { swap(w, h); }
-						if (score_rect_for_skyline_bottom_left(skyline_index, w, h, x, rect_score)) {
-							if (best_rect_score < rect_score) {
-								best_rect_score = rect_score;
-								rect->lb_point.x = x;
-								rect->lb_point.y = _skyline[skyline_index].y;
-								rect->rotation = rotate ? Rotation::_90_ : Rotation::_0_;
-								best_rect_index = p;
-							}
-						}
+				switch (shape_of<Shapes>(p)) {
+				case Shape::R: { // ռλ
+					if constexpr (has_shape(Shapes, Shape::R)) {
+						ws.rect_block.add(p, candidates.size(), _dims[p].rect.width, _dims[p].rect.height);
+						candidates.push_back({ p, 0, 0, -1 });
 					}
 					break;
 				}
 				case Shape::L: {
-					auto lshape = dynamic_pointer_cast<lshape_t>(_src.at(p));
-					skyline_t score_skyline; coord_t score_height; coord_t score_waste;
-					if (score_lshape_for_skyline_bottom_left(skyline_index, lshape, score_skyline, score_height, score_waste)) {
-						if (best_l_waste > score_waste ||
-							best_l_waste == score_waste && best_ltc_delta > score_skyline.size() - _skyline.size()) {
-							best_l_waste = score_waste;
-							best_ltc_delta = score_skyline.size() - _skyline.size();
-							best_ltc_index = p;
-							best_ltc_skyline = score_skyline;
-							best_ltc_height = score_height;
+					if constexpr (has_shape(Shapes, Shape::L)) {
+						SkylinePatch score_skyline; coord_t score_height; coord_t score_waste;
+						if (score_lshape_for_skyline_bottom_left(ws, skyline_index, _dims[p].lshape, ws.placements[p], score_skyline, score_height, score_waste)) {
+							candidates.push_back({ p, score_skyline.size() - ws.skyline.size(), score_waste, 0 });
+							if (offer_candidate<Shapes>(candidates.back(), state)) {
+								best_ltc_skyline = score_skyline;
+								best_ltc_height = score_height;
+							}
 						}
 					}
 					break;
 				}
 				case Shape::T: {
-					auto tshape = dynamic_pointer_cast<tshape_t>(_src.at(p));
-					skyline_t score_skyline; coord_t score_height;
-					if (score_tshape_for_skyline_bottom_left(skyline_index, tshape, score_skyline, score_height)) {
-						if (best_ltc_delta > score_skyline.size() - _skyline.size()) {
-							best_ltc_delta = score_skyline.size() - _skyline.size();
-							best_ltc_index = p;
-							best_ltc_skyline = score_skyline;
-							best_ltc_height = score_height;
+					if constexpr (has_shape(Shapes, Shape::T)) {
+						SkylinePatch score_skyline; coord_t score_height;
+						if (score_tshape_for_skyline_bottom_left(ws, skyline_index, _dims[p].tshape, ws.placements[p], score_skyline, score_height)) {
+							candidates.push_back({ p, score_skyline.size() - ws.skyline.size(), 0, 0 });
+							if (offer_candidate<Shapes>(candidates.back(), state)) {
+								best_ltc_skyline = score_skyline;
+								best_ltc_height = score_height;
+							}
 						}
 					}
 					break;
 				}
 				case Shape::C: {
-					auto concave = dynamic_pointer_cast<concave_t>(_src.at(p));
-					skyline_t score_skyline; coord_t score_height;
-					if (score_concave_for_skyline_bottom_left(skyline_index, concave, score_skyline, score_height)) {
-						if (best_ltc_delta > score_skyline.size() - _skyline.size()) {
-							best_ltc_delta = score_skyline.size() - _skyline.size();
-							best_ltc_index = p;
-							best_ltc_skyline = score_skyline;
-							best_ltc_height = score_height;
+					if constexpr (has_shape(Shapes, Shape::C)) {
+						SkylinePatch score_skyline; coord_t score_height;
+						if (score_concave_for_skyline_bottom_left(ws, skyline_index, _dims[p].concave, ws.placements[p], score_skyline, score_height)) {
+							candidates.push_back({ p, score_skyline.size() - ws.skyline.size(), 0, 0 });
+							if (offer_candidate<Shapes>(candidates.back(), state)) {
+								best_ltc_skyline = score_skyline;
+								best_ltc_height = score_height;
+							}
 						}
 					}
 					break;
@@ -349,64 +1027,80 @@ namespace mbp {
 				default: { assert(false); break; }
 				}
 			}
+			if (has_shape(Shapes, Shape::R) && !ws.rect_block.empty()) { score_rect_block<Shapes>(ws, skyline_index, candidates, first_candidate, state); }
+
+			best_polygon_index = pick_polygon<Shapes>(state);
+			if (best_polygon_index == NO_POLYGON) { return false; } // Ų
 
-			if (best_rect_score == -1) { // RŲ
-				if (best_ltc_delta == numeric_limits<int>::max())  // LTCŲ
-					return false;
-				else  // LTCܷ
-					best_polygon_index = best_ltc_index;
+			if (shape_of<Shapes>(best_polygon_index) == Shape::R) { best_skyline_height = place_rect_on_skyline(ws, skyline_index, best_polygon_index); }
+			else {
+				best_ltc_skyline.apply(ws.skyline);
+				best_skyline_height = best_ltc_height;
 			}
-			else { // Rܷ£`best_rect_skyline``best_rect_height`
-				auto rect = dynamic_pointer_cast<rect_t>(_src.at(best_rect_index));
-				coord_t w = rect->width, h = rect->height;
-				if (rect->rotation == Rotation::_90_) { swap(w, h); }
-				best_rect_skyline = _skyline;
-				skylinenode_t new_skyline_node{ rect->lb_point.x, rect->lb_point.y + h, w };
-				if (rect->lb_point.x == best_rect_skyline[skyline_index].x) { // 
-					best_rect_skyline.insert(best_rect_skyline.begin() + skyline_index, new_skyline_node);
-					best_rect_skyline[skyline_index + 1].x += w;
-					best_rect_skyline[skyline_index + 1].width -= w;
-					merge_skylines(best_rect_skyline);
-				}
-				else { // 
-					best_rect_skyline.insert(best_rect_skyline.begin() + skyline_index + 1, new_skyline_node);
-					best_rect_skyline[skyline_index].width -= w;
-					merge_skylines(best_rect_skyline);
-				}
-				best_rect_height = new_skyline_node.y;
+			return true;
+		}
 
-				if (best_ltc_delta == numeric_limits<int>::max())  // LTCŲ
-					best_polygon_index = best_rect_index;
-				else // LTCܷ
-					best_polygon_index = _src.at(best_rect_index)->area > _src.at(best_ltc_index)->area ? best_rect_index : best_ltc_index;
+		/// _placementsеλ÷þΣ_skylineؾϱ߽߶
+		coord_t place_rect_on_skyline(Workspace &ws, size_t skyline_index, size_t p) const {
+			const placement_t &placement = ws.placements[p];
+			coord_t w = _dims[p].rect.width, h = _dims[p].rect.height;
+			if (placement.rotation == Rotation::_90_) { swap(w, h); }
+			skylinenode_t new_skyline_node{ placement.lb_point.x, placement.lb_point.y + h, w };
+			if (placement.lb_point.x == ws.skyline[skyline_index].x) { // 
+				ws.skyline.insert(ws.skyline.begin() + skyline_index, new_skyline_node);
+				ws.skyline[skyline_index + 1].x += w;
+				ws.skyline[skyline_index + 1].width -= w;
 			}
+			else { // 
+				ws.skyline.insert(ws.skyline.begin() + skyline_index + 1, new_skyline_node);
+				ws.skyline[skyline_index].width -= w;
+			}
+			merge_skylines(ws.skyline, skyline_index, skyline_index + 2);
+			return new_skyline_node.y;
+		}
 
-			switch (_src.at(best_polygon_index)->shape()) {
+		/// ֹµǰţѡΪµʱtrue
+		template<ShapeSet Shapes>
+		bool offer_candidate(const Candidate &candidate, PickState &state) const {
+			switch (shape_of<Shapes>(candidate.polygon)) {
 			case Shape::R:
-				_skyline = best_rect_skyline;
-				best_skyline_height = best_rect_height;
-				best_dst_node = make_shared<rect_t>(*dynamic_pointer_cast<rect_t>(_src.at(best_polygon_index)));
-				break;
+				if (state.rect_score < candidate.score) {
+					state.rect_score = candidate.score;
+					state.rect_index = candidate.polygon;
+					return true;
+				}
+				return false;
 			case Shape::L:
-				_skyline = best_ltc_skyline;
-				best_skyline_height = best_ltc_height;
-				best_dst_node = make_shared<lshape_t>(*dynamic_pointer_cast<lshape_t>(_src.at(best_polygon_index)));
-				break;
+				if (state.l_waste > candidate.waste ||
+					state.l_waste == candidate.waste && state.ltc_delta > candidate.delta) {
+					state.l_waste = candidate.waste;
+					state.ltc_delta = candidate.delta;
+					state.ltc_index = candidate.polygon;
+					return true;
+				}
+				return false;
 			case Shape::T:
-				_skyline = best_ltc_skyline;
-				best_skyline_height = best_ltc_height;
-				best_dst_node = make_shared<tshape_t>(*dynamic_pointer_cast<tshape_t>(_src.at(best_polygon_index)));
-				break;
 			case Shape::C:
-				_skyline = best_ltc_skyline;
-				best_skyline_height = best_ltc_height;
-				best_dst_node = make_shared<concave_t>(*dynamic_pointer_cast<concave_t>(_src.at(best_polygon_index)));
-				break;
+				if (state.ltc_delta > candidate.delta) {
+					state.ltc_delta = candidate.delta;
+					state.ltc_index = candidate.polygon;
+					return true;
+				}
+				return false;
 			default:
 				assert(false);
-				break;
+				return false;
 			}
-			return true;
+		}
+
+		/// RLTCܷʱѡϴߣŲʱNO_POLYGON
+		template<ShapeSet Shapes>
+		size_t pick_polygon(const PickState &state) const {
+			if constexpr (Shapes == shape_bit(Shape::R)) { return state.rect_score == -1 ? NO_POLYGON : state.rect_index; }
+			bool ltc_fit = state.ltc_delta != numeric_limits<int>::max();
+			if (state.rect_score == -1) { return ltc_fit ? state.ltc_index : NO_POLYGON; }
+			if (!ltc_fit) { return state.rect_index; }
+			return _areas[state.rect_index] > _areas[state.ltc_index] ? state.rect_index : state.ltc_index;
 		}
 
 		/// Space
@@ -418,31 +1112,85 @@ namespace mbp {
 			coord_t hr;
 		};
 
-		SkylineSpace skyline_nodo_to_space(size_t skyline_index) {
+		/// skylineľֲ޸ģöֻĶͶμڽڵ㣬ϲҲԽҸڵĴڣ
+		/// ˴ʱֻƸôڣsize()޸ĺskylineĽڵѡд
+		class SkylinePatch {
+		public:
+			SkylinePatch() = default;
+
+			SkylinePatch(const skyline_t &skyline, size_t skyline_index) {
+				_first = skyline_index >= 2 ? skyline_index - 2 : 0;
+				_last = min(skyline_index + 3, skyline.size());
+				_size = _last - _first;
+				_total = skyline.size();
+				copy(skyline.begin() + _first, skyline.begin() + _last, _nodes);
+			}
+
+			skylinenode_t &operator[](size_t index) { return _nodes[index - _first]; }
+
+			size_t size() const { return _total; }
+
+			void insert(size_t index, const skylinenode_t &node) {
+				assert(_size < CAPACITY);
+				copy_backward(_nodes + (index - _first), _nodes + _size, _nodes + _size + 1);
+				_nodes[index - _first] = node;
+				++_size; ++_total;
+			}
+
+			/// merge_skylinesͬĵ˺ϲ
+			void merge() {
+				size_t size = 0;
+				for (size_t i = 0; i < _size; ++i) {
+					if (_nodes[i].width <= 0) { continue; }
+					if (size > 0 && _nodes[size - 1].y == _nodes[i].y) { _nodes[size - 1].width += _nodes[i].width; }
+					else { _nodes[size++] = _nodes[i]; }
+				}
+				_total -= _size - size;
+				_size = size;
+			}
+
+			void apply(skyline_t &skyline) const {
+				size_t old_size = _last - _first;
+				if (_size > old_size) { skyline.insert(skyline.begin() + _last, _size - old_size, skylinenode_t()); }
+				else { skyline.erase(skyline.begin() + _first + _size, skyline.begin() + _last); }
+				copy(_nodes, _nodes + _size, skyline.begin() + _first);
+			}
+
+		private:
+			static constexpr size_t CAPACITY = 8; // 5ڵ㣬ÿְڷ3
+
+			size_t _first;  // ԭskylineеķΧ[_first, _last)
+			size_t _last;
+			size_t _size;   // ڵǰڵ
+			size_t _total;  // skylineǰڵ
+			skylinenode_t _nodes[CAPACITY];
+		};
+
+		SkylineSpace skyline_nodo_to_space(const Workspace &ws, size_t skyline_index) const {
 			coord_t hl, hr;
-			if (_skyline.size() == 1) {
-				hl = hr = INF - _skyline[skyline_index].y;
+			if (ws.skyline.size() == 1) {
+				hl = hr = INF - ws.skyline[skyline_index].y;
 			}
 			else if (skyline_index == 0) {
-				hl = INF - _skyline[skyline_index].y;
-				hr = _skyline[skyline_index + 1].y - _skyline[skyline_index].y;
+				hl = INF - ws.skyline[skyline_index].y;
+				hr = ws.skyline[skyline_index + 1].y - ws.skyline[skyline_index].y;
 			}
-			else if (skyline_index == _skyline.size() - 1) {
-				hl = _skyline[skyline_index - 1].y - _skyline[skyline_index].y;
-				hr = INF - _skyline[skyline_index].y;
+			else if (skyline_index == ws.skyline.size() - 1) {
+				hl = ws.skyline[skyline_index - 1].y - ws.skyline[skyline_index].y;
+				hr = INF - ws.skyline[skyline_index].y;
 			}
 			else {
-				hl = _skyline[skyline_index - 1].y - _skyline[skyline_index].y;
-				hr = _skyline[skyline_index + 1].y - _skyline[skyline_index].y;
+				hl = ws.skyline[skyline_index - 1].y - ws.skyline[skyline_index].y;
+				hr = ws.skyline[skyline_index + 1].y - ws.skyline[skyline_index].y;
 			}
-			return { _skyline[skyline_index].x, _skyline[skyline_index].y, _skyline[skyline_index].width, hl, hr };
+			return { ws.skyline[skyline_index].x, ws.skyline[skyline_index].y, ws.skyline[skyline_index].width, hl, hr };
 		}
 
 		/// Rֲ
-		bool score_rect_for_skyline_bottom_left(size_t skyline_index, coord_t width, coord_t height, coord_t &x, int &score) {
-			if (width > _skyline[skyline_index].width) { return false; }
+		bool score_rect_for_skyline_bottom_left(const Workspace &ws, size_t skyline_index, coord_t width, coord_t height, coord_t &x, int &score) const {
+			if (width > ws.skyline[skyline_index].width) { return false; }
 
-			SkylineSpace space = skyline_nodo_to_space(skyline_index);
+			SkylineSpace space = skyline_nodo_to_space(ws, skyline_index);
 			if (space.hl >= space.hr) {
 				if (width == space.width && height == space.hl) { score = 7; }
 				else if (width == space.width && height == space.hr) { score = 6; }
@@ -454,8 +1202,8 @@ namespace mbp {
 				else if (width < space.width && height != space.hl) { score = 0; }
 				else { return false; }
 
-				if (score == 2) { x = _skyline[skyline_index].x + _skyline[skyline_index].width - width; }
-				else { x = _skyline[skyline_index].x; }
+				if (score == 2) { x = ws.skyline[skyline_index].x + ws.skyline[skyline_index].width - width; }
+				else { x = ws.skyline[skyline_index].x; }
 			}
 			else { // hl < hr
 				if (width == space.width && height == space.hr) { score = 7; }
@@ -468,209 +1216,245 @@ namespace mbp {
 				else if (width < space.width && height != space.hr) { score = 0; } // 
 				else { return false; }
 
-				if (score == 4 || score == 0) { x = _skyline[skyline_index].x + _skyline[skyline_index].width - width; }
-				else { x = _skyline[skyline_index].x; }
+				if (score == 4 || score == 0) { x = ws.skyline[skyline_index].x + ws.skyline[skyline_index].width - width; }
+				else { x = ws.skyline[skyline_index].x; }
 			}
 			if (x + width > _bin_width) { return false; }
 
 			return true;
 		}
 
+		/// rect_blockеľ֣˳ύstateƳŲµռλѡ
+		/// RLTCѡ״̬Ӱ죬ӺύRıѡѡбҲ˳
+		template<ShapeSet Shapes>
+		void score_rect_block(Workspace &ws, size_t skyline_index, vector<Candidate> &candidates, size_t first_candidate, PickState &state) const {
+			const skylinenode_t &node = ws.skyline[skyline_index];
+			SkylineSpace space = skyline_nodo_to_space(ws, skyline_index);
+			RectBlock &block = ws.rect_block;
+			block.score(space.width, space.hl, space.hr);
+
+			bool unfit = false;
+			for (size_t i = 0; i < block.size(); ++i) {
+				size_t p = block.polygon(i);
+				Candidate &candidate = candidates[block.slot(i)];
+				for (int rotate = 0; rotate <= 1; ++rotate) {
+					int rect_score = block.score(i, rotate);
+					if (rect_score == -1) { continue; }
+					coord_t width = block.width(i, rotate);
+					// hl >= hrʱ2ֿң4ֺ0ֿ
+					bool right = space.hl >= space.hr ? rect_score == 2 : rect_score == 4 || rect_score == 0;
+					coord_t x = right ? node.x + node.width - width : node.x;
+					if (x + width > _bin_width) { continue; }
+					candidate.score = max(candidate.score, rect_score);
+					if (offer_candidate<Shapes>({ p, 0, 0, rect_score }, state)) {
+						ws.placements[p].lb_point.x = x;
+						ws.placements[p].lb_point.y = node.y;
+						ws.placements[p].rotation = rotate ? Rotation::_90_ : Rotation::_0_;
+					}
+				}
+				unfit |= candidate.score == -1;
+			}
+			if (unfit) {
+				candidates.erase(remove_if(candidates.begin() + first_candidate, candidates.end(),
+					[](const Candidate &c) { return c.score == -1; }), candidates.end());
+			}
+		}
+
 		/// Lֲ
-		bool score_lshape_for_skyline_bottom_left(size_t skyline_index, lshape_ptr &lshape, skyline_t &skyline, coord_t &skyline_height, coord_t &min_waste) {
-			SkylineSpace space = skyline_nodo_to_space(skyline_index);
-			skyline_t skyline_0l = _skyline, skyline_0r = _skyline,
-				skyline_90 = _skyline, skyline_180 = _skyline,
-				skyline_270l = _skyline, skyline_270r = _skyline;
+		bool score_lshape_for_skyline_bottom_left(const Workspace &ws, size_t skyline_index, const LShapeDims &lshape, placement_t &placement, SkylinePatch &skyline, coord_t &skyline_height, coord_t &min_waste) const {
+			SkylineSpace space = skyline_nodo_to_space(ws, skyline_index);
+			SkylinePatch skyline_0l(ws.skyline, skyline_index), skyline_0r(ws.skyline, skyline_index),
+				skyline_90(ws.skyline, skyline_index), skyline_180(ws.skyline, skyline_index),
+				skyline_270l(ws.skyline, skyline_index), skyline_270r(ws.skyline, skyline_index);
 			int min_delta = numeric_limits<int>::max();
 			min_waste = numeric_limits<coord_t>::max(); // ˷С
 
-			if (lshape->hd <= space.width) { // 0&
+			if (lshape.hd <= space.width) { // 0&
 				// lb_point
 				point_t lb_point_0l = { skyline_0l[skyline_index].x, skyline_0l[skyline_index].y };
 				// update
-				skyline_0l[skyline_index].y += lshape->vl;
-				skyline_0l[skyline_index].width = lshape->hu;
+				skyline_0l[skyline_index].y += lshape.vl;
+				skyline_0l[skyline_index].width = lshape.hu;
 				// add
-				skyline_0l.insert(skyline_0l.begin() + skyline_index + 1, {
+				skyline_0l.insert(skyline_index + 1, {
 					skyline_0l[skyline_index].x + skyline_0l[skyline_index].width,
-					skyline_0l[skyline_index].y - lshape->vm,
-					lshape->hm });
-				skyline_0l.insert(skyline_0l.begin() + skyline_index + 2, {
+					skyline_0l[skyline_index].y - lshape.vm,
+					lshape.hm });
+				skyline_0l.insert(skyline_index + 2, {
 					skyline_0l[skyline_index + 1].x + skyline_0l[skyline_index + 1].width,
-					skyline_0l[skyline_index + 1].y - lshape->vr,
-					space.width - lshape->hd });
+					skyline_0l[skyline_index + 1].y - lshape.vr,
+					space.width - lshape.hd });
 				// merge
 				coord_t skyline_height_bk = skyline_0l[skyline_index].y;  // ֹmergeskyline_indexʧЧ
-				merge_skylines(skyline_0l);
+				skyline_0l.merge();
 				// delta
-				if (min_delta > skyline_0l.size() - _skyline.size()) {
-					min_delta = skyline_0l.size() - _skyline.size();
+				if (min_delta > skyline_0l.size() - ws.skyline.size()) {
+					min_delta = skyline_0l.size() - ws.skyline.size();
 					min_waste = 0;
-					lshape->rotation = Rotation::_0_;
-					lshape->lb_point = lb_point_0l;
+					placement.rotation = Rotation::_0_;
+					placement.lb_point = lb_point_0l;
 					skyline = skyline_0l;
 					skyline_height = skyline_height_bk;
 				}
 			}
 
-			if (lshape->hd < space.width) { // 0&
+			if (lshape.hd < space.width) { // 0&
 				// lb_point
-				point_t lb_point_0r = { skyline_0r[skyline_index].x + space.width - lshape->hd, skyline_0r[skyline_index].y };
+				point_t lb_point_0r = { skyline_0r[skyline_index].x + space.width - lshape.hd, skyline_0r[skyline_index].y };
 				// update
-				skyline_0r[skyline_index].width -= lshape->hd;
+				skyline_0r[skyline_index].width -= lshape.hd;
 				// add
-				skyline_0r.insert(skyline_0r.begin() + skyline_index + 1, {
+				skyline_0r.insert(skyline_index + 1, {
 					skyline_0r[skyline_index].x + skyline_0r[skyline_index].width,
-					skyline_0r[skyline_index].y + lshape->vl,
-					lshape->hu });
-				skyline_0r.insert(skyline_0r.begin() + skyline_index + 2, {
+					skyline_0r[skyline_index].y + lshape.vl,
+					lshape.hu });
+				skyline_0r.insert(skyline_index + 2, {
 					skyline_0r[skyline_index + 1].x + skyline_0r[skyline_index + 1].width,
-					skyline_0r[skyline_index + 1].y - lshape->vm,
-					lshape->hm });
+					skyline_0r[skyline_index + 1].y - lshape.vm,
+					lshape.hm });
 				// merge
 				coord_t skyline_height_bk = skyline_0r[skyline_index + 1].y;
-				merge_skylines(skyline_0r);
+				skyline_0r.merge();
 				// delta
-				if (min_delta > skyline_0r.size() - _skyline.size()) {
-					min_delta = skyline_0r.size() - _skyline.size();
+				if (min_delta > skyline_0r.size() - ws.skyline.size()) {
+					min_delta = skyline_0r.size() - ws.skyline.size();
 					min_waste = 0;
-					lshape->rotation = Rotation::_0_;
-					lshape->lb_point = lb_point_0r;
+					placement.rotation = Rotation::_0_;
+					placement.lb_point = lb_point_0r;
 					skyline = skyline_0r;
 					skyline_height = skyline_height_bk;
 				}
 			}
 
-			if (lshape->vl <= space.width) { // 270&
+			if (lshape.vl <= space.width) { // 270&
 				// lb_point
-				point_t lb_point_270l = { skyline_270l[skyline_index].x + lshape->vl, skyline_270l[skyline_index].y };
+				point_t lb_point_270l = { skyline_270l[skyline_index].x + lshape.vl, skyline_270l[skyline_index].y };
 				// update
-				skyline_270l[skyline_index].y += lshape->hu;
-				skyline_270l[skyline_index].width = lshape->vm;
+				skyline_270l[skyline_index].y += lshape.hu;
+				skyline_270l[skyline_index].width = lshape.vm;
 				// add
-				skyline_270l.insert(skyline_270l.begin() + skyline_index + 1, {
+				skyline_270l.insert(skyline_index + 1, {
 					skyline_270l[skyline_index].x + skyline_270l[skyline_index].width,
-					skyline_270l[skyline_index].y + lshape->hm,
-					lshape->vr });
-				skyline_270l.insert(skyline_270l.begin() + skyline_index + 2, {
+					skyline_270l[skyline_index].y + lshape.hm,
+					lshape.vr });
+				skyline_270l.insert(skyline_index + 2, {
 					skyline_270l[skyline_index + 1].x + skyline_270l[skyline_index + 1].width,
-					skyline_270l[skyline_index + 1].y - lshape->hd,
-					space.width - lshape->vl });
+					skyline_270l[skyline_index + 1].y - lshape.hd,
+					space.width - lshape.vl });
 				// merge
 				coord_t skyline_height_bk = skyline_270l[skyline_index + 1].y;
-				merge_skylines(skyline_270l);
+				skyline_270l.merge();
 				// delta
-				if (min_delta > skyline_270l.size() - _skyline.size()) {
-					min_delta = skyline_270l.size() - _skyline.size();
+				if (min_delta > skyline_270l.size() - ws.skyline.size()) {
+					min_delta = skyline_270l.size() - ws.skyline.size();
 					min_waste = 0;
-					lshape->rotation = Rotation::_270_;
-					lshape->lb_point = lb_point_270l;
+					placement.rotation = Rotation::_270_;
+					placement.lb_point = lb_point_270l;
 					skyline = skyline_270l;
 					skyline_height = skyline_height_bk;
 				}
 			}
 
-			if (lshape->vl < space.width) { // 270&
+			if (lshape.vl < space.width) { // 270&
 				// lb_point
 				point_t lb_point_270r = { skyline_270r[skyline_index].x + space.width, skyline_270r[skyline_index].y };
 				// update
-				skyline_270r[skyline_index].width -= lshape->vl;
+				skyline_270r[skyline_index].width -= lshape.vl;
 				// add
-				skyline_270r.insert(skyline_270r.begin() + skyline_index + 1, {
+				skyline_270r.insert(skyline_index + 1, {
 					skyline_270r[skyline_index].x + skyline_270r[skyline_index].width,
-					skyline_270r[skyline_index].y + lshape->hu,
-					lshape->vm });
-				skyline_270r.insert(skyline_270r.begin() + skyline_index + 2, {
+					skyline_270r[skyline_index].y + lshape.hu,
+					lshape.vm });
+				skyline_270r.insert(skyline_index + 2, {
 					skyline_270r[skyline_index + 1].x + skyline_270r[skyline_index + 1].width,
-					skyline_270r[skyline_index + 1].y + lshape->hm,
-					lshape->vr });
+					skyline_270r[skyline_index + 1].y + lshape.hm,
+					lshape.vr });
 				// merge
 				coord_t skyline_height_bk = skyline_270r[skyline_index + 2].y;
-				merge_skylines(skyline_270r);
+				skyline_270r.merge();
 				// delta
-				if (min_delta > skyline_270r.size() - _skyline.size()) {
-					min_delta = skyline_270r.size() - _skyline.size();
+				if (min_delta > skyline_270r.size() - ws.skyline.size()) {
+					min_delta = skyline_270r.size() - ws.skyline.size();
 					min_waste = 0;
-					lshape->rotation = Rotation::_270_;
-					lshape->lb_point = lb_point_270r;
+					placement.rotation = Rotation::_270_;
+					placement.lb_point = lb_point_270r;
 					skyline = skyline_270r;
 					skyline_height = skyline_height_bk;
 				}
 			}
 
 			if (skyline_index + 1 < skyline_90.size()
-				&& lshape->vm <= skyline_90[skyline_index + 1].width
-				//&& lshape->hm == space.hr // עͣ˷
-				&& lshape->vr <= space.width) {
-				coord_t new_skyline_height = max(lshape->hd, lshape->hu + space.hr);
+				&& lshape.vm <= skyline_90[skyline_index + 1].width
+				//&& lshape.hm == space.hr // עͣ˷
+				&& lshape.vr <= space.width) {
+				coord_t new_skyline_height = max(lshape.hd, lshape.hu + space.hr);
 				// lb_point
-				point_t lb_point_90 = { skyline_90[skyline_index].x + space.width - lshape->vr, skyline_90[skyline_index].y + new_skyline_height };
+				point_t lb_point_90 = { skyline_90[skyline_index].x + space.width - lshape.vr, skyline_90[skyline_index].y + new_skyline_height };
 				// update
-				skyline_90[skyline_index].width -= lshape->vr;
+				skyline_90[skyline_index].width -= lshape.vr;
 				// add
-				skyline_90.insert(skyline_90.begin() + skyline_index + 1, {
+				skyline_90.insert(skyline_index + 1, {
 					skyline_90[skyline_index].x + skyline_90[skyline_index].width,
 					skyline_90[skyline_index].y + new_skyline_height,
-					lshape->vl });
+					lshape.vl });
 				// delete right
-				skyline_90[skyline_index + 2].x += lshape->vm;
-				skyline_90[skyline_index + 2].width -= lshape->vm;
+				skyline_90[skyline_index + 2].x += lshape.vm;
+				skyline_90[skyline_index + 2].width -= lshape.vm;
 				// merge
 				coord_t skyline_height_bk = skyline_90[skyline_index + 1].y;
-				merge_skylines(skyline_90);
+				skyline_90.merge();
 				// waste
 				//coord_t old_space = min(space.hl, space.hr) * space.width;
 				//coord_t new_space = min(space.hl, new_skyline_height) * skyline_90[skyline_index].width;
-				coord_t waste_90 = lshape->hd > lshape->hu + space.hr ?
-					(lshape->hd - lshape->hu - space.hr) * lshape->vm : // Ϸ˷
-					(lshape->hu + space.hr - lshape->hd) * lshape->vr;  // ·˷
+				coord_t waste_90 = lshape.hd > lshape.hu + space.hr ?
+					(lshape.hd - lshape.hu - space.hr) * lshape.vm : // Ϸ˷
+					(lshape.hu + space.hr - lshape.hd) * lshape.vr;  // ·˷
 				// delta
 				if (min_waste > waste_90 ||
-					min_waste == waste_90 && min_delta > skyline_90.size() - _skyline.size()) {
+					min_waste == waste_90 && min_delta > skyline_90.size() - ws.skyline.size()) {
 					min_waste = waste_90;
-					min_delta = skyline_90.size() - _skyline.size();
-					lshape->rotation = Rotation::_90_;
-					lshape->lb_point = lb_point_90;
+					min_delta = skyline_90.size() - ws.skyline.size();
+					placement.rotation = Rotation::_90_;
+					placement.lb_point = lb_point_90;
 					skyline = skyline_90;
 					skyline_height = skyline_height_bk;
 				}
 			}
 
 			if (skyline_index >= 1
-				&& lshape->hm <= skyline_180[skyline_index - 1].width
-				//&& lshape->vm == space.hl // עͣ˷
-				&& lshape->hu <= space.width) {
-				coord_t new_skyline_height = max(lshape->vl, lshape->vr + space.hl);
+				&& lshape.hm <= skyline_180[skyline_index - 1].width
+				//&& lshape.vm == space.hl // עͣ˷
+				&& lshape.hu <= space.width) {
+				coord_t new_skyline_height = max(lshape.vl, lshape.vr + space.hl);
 				// lb_point
-				point_t lb_point_180 = { skyline_180[skyline_index].x + lshape->hu, skyline_180[skyline_index].y + new_skyline_height };
+				point_t lb_point_180 = { skyline_180[skyline_index].x + lshape.hu, skyline_180[skyline_index].y + new_skyline_height };
 				// update
-				skyline_180[skyline_index].x -= lshape->hm;
+				skyline_180[skyline_index].x -= lshape.hm;
 				skyline_180[skyline_index].y += new_skyline_height;
-				skyline_180[skyline_index].width = lshape->hd;
+				skyline_180[skyline_index].width = lshape.hd;
 				// add
-				skyline_180.insert(skyline_180.begin() + skyline_index + 1, {
+				skyline_180.insert(skyline_index + 1, {
 					skyline_180[skyline_index].x + skyline_180[skyline_index].width,
 					skyline_180[skyline_index].y - new_skyline_height,
-					space.width - lshape->hu });
+					space.width - lshape.hu });
 				// delete left
-				skyline_180[skyline_index - 1].width -= lshape->hm;
+				skyline_180[skyline_index - 1].width -= lshape.hm;
 				// merge
 				coord_t skyline_height_bk = skyline_180[skyline_index].y;
-				merge_skylines(skyline_180);
+				skyline_180.merge();
 				// waste
 				//coord_t old_space = min(space.hl, space.hr) * space.width;
 				//coord_t new_space = min(space.hr, new_skyline_height) * skyline_180[skyline_index + 1].width;
-				coord_t waste_180 = lshape->vl > lshape->vr + space.hl ?
-					(lshape->vl - lshape->vr - space.hl) * lshape->hm :
-					(lshape->vr + space.hl - lshape->vl) * lshape->hu;
+				coord_t waste_180 = lshape.vl > lshape.vr + space.hl ?
+					(lshape.vl - lshape.vr - space.hl) * lshape.hm :
+					(lshape.vr + space.hl - lshape.vl) * lshape.hu;
 				// delta
 				if (min_waste > waste_180 ||
-					min_waste == waste_180 && min_delta > skyline_180.size() - _skyline.size()) {
+					min_waste == waste_180 && min_delta > skyline_180.size() - ws.skyline.size()) {
 					min_waste = waste_180;
-					min_delta = skyline_180.size() - _skyline.size();
-					lshape->rotation = Rotation::_180_;
-					lshape->lb_point = lb_point_180;
+					min_delta = skyline_180.size() - ws.skyline.size();
+					placement.rotation = Rotation::_180_;
+					placement.lb_point = lb_point_180;
 					skyline = skyline_180;
 					skyline_height = skyline_height_bk;
 				}
@@ -681,167 +1465,167 @@ namespace mbp {
 		}
 
 		/// Tֲ
-		bool score_tshape_for_skyline_bottom_left(size_t skyline_index, tshape_ptr &tshape, skyline_t &skyline, coord_t &skyline_height) {
-			SkylineSpace space = skyline_nodo_to_space(skyline_index);
-			skyline_t skyline_0l = _skyline, skyline_0r = _skyline,
-				skyline_90 = _skyline, skyline_180 = _skyline, skyline_270 = _skyline;
+		bool score_tshape_for_skyline_bottom_left(const Workspace &ws, size_t skyline_index, const TShapeDims &tshape, placement_t &placement, SkylinePatch &skyline, coord_t &skyline_height) const {
+			SkylineSpace space = skyline_nodo_to_space(ws, skyline_index);
+			SkylinePatch skyline_0l(ws.skyline, skyline_index), skyline_0r(ws.skyline, skyline_index),
+				skyline_90(ws.skyline, skyline_index), skyline_180(ws.skyline, skyline_index), skyline_270(ws.skyline, skyline_index);
 			int min_delta = numeric_limits<int>::max();
 
-			if (tshape->hd <= space.width) { // 0&
+			if (tshape.hd <= space.width) { // 0&
 				// lb_point
 				point_t lb_point_0l = { skyline_0l[skyline_index].x, skyline_0l[skyline_index].y };
 				// update
-				skyline_0l[skyline_index].y += tshape->vld;
-				skyline_0l[skyline_index].width = tshape->hl;
+				skyline_0l[skyline_index].y += tshape.vld;
+				skyline_0l[skyline_index].width = tshape.hl;
 				// add
-				skyline_0l.insert(skyline_0l.begin() + skyline_index + 1, {
+				skyline_0l.insert(skyline_index + 1, {
 					skyline_0l[skyline_index].x + skyline_0l[skyline_index].width,
-					skyline_0l[skyline_index].y + tshape->vlu,
-					tshape->hu });
-				skyline_0l.insert(skyline_0l.begin() + skyline_index + 2, {
+					skyline_0l[skyline_index].y + tshape.vlu,
+					tshape.hu });
+				skyline_0l.insert(skyline_index + 2, {
 					skyline_0l[skyline_index + 1].x + skyline_0l[skyline_index + 1].width,
-					skyline_0l[skyline_index + 1].y - tshape->vru,
-					tshape->hr });
-				skyline_0l.insert(skyline_0l.begin() + skyline_index + 3, {
+					skyline_0l[skyline_index + 1].y - tshape.vru,
+					tshape.hr });
+				skyline_0l.insert(skyline_index + 3, {
 					skyline_0l[skyline_index + 2].x + skyline_0l[skyline_index + 2].width,
-					skyline_0l[skyline_index + 2].y - tshape->vrd,
-					space.width - tshape->hd });
+					skyline_0l[skyline_index + 2].y - tshape.vrd,
+					space.width - tshape.hd });
 				// merge
 				coord_t skyline_height_bk = skyline_0l[skyline_index + 1].y;
-				merge_skylines(skyline_0l);
+				skyline_0l.merge();
 				// delta
-				if (min_delta > skyline_0l.size() - _skyline.size()) {
-					min_delta = skyline_0l.size() - _skyline.size();
-					tshape->rotation = Rotation::_0_;
-					tshape->lb_point = lb_point_0l;
+				if (min_delta > skyline_0l.size() - ws.skyline.size()) {
+					min_delta = skyline_0l.size() - ws.skyline.size();
+					placement.rotation = Rotation::_0_;
+					placement.lb_point = lb_point_0l;
 					skyline = skyline_0l;
 					skyline_height = skyline_height_bk;
 				}
 			}
 
-			if (tshape->hd < space.width) { // 0&
+			if (tshape.hd < space.width) { // 0&
 				// lb_point
-				point_t lb_point_0r = { skyline_0r[skyline_index].x + space.width - tshape->hd, skyline_0r[skyline_index].y };
+				point_t lb_point_0r = { skyline_0r[skyline_index].x + space.width - tshape.hd, skyline_0r[skyline_index].y };
 				// update
-				skyline_0r[skyline_index].width -= tshape->hd;
+				skyline_0r[skyline_index].width -= tshape.hd;
 				// add
-				skyline_0r.insert(skyline_0r.begin() + skyline_index + 1, {
+				skyline_0r.insert(skyline_index + 1, {
 					skyline_0r[skyline_index].x + skyline_0r[skyline_index].width,
-					skyline_0r[skyline_index].y + tshape->vld,
-					tshape->hl });
-				skyline_0r.insert(skyline_0r.begin() + skyline_index + 2, {
+					skyline_0r[skyline_index].y + tshape.vld,
+					tshape.hl });
+				skyline_0r.insert(skyline_index + 2, {
 					skyline_0r[skyline_index + 1].x + skyline_0r[skyline_index + 1].width,
-					skyline_0r[skyline_index + 1].y + tshape->vlu,
-					tshape->hu });
-				skyline_0r.insert(skyline_0r.begin() + skyline_index + 3, {
+					skyline_0r[skyline_index + 1].y + tshape.vlu,
+					tshape.hu });
+				skyline_0r.insert(skyline_index + 3, {
 					skyline_0r[skyline_index + 2].x + skyline_0r[skyline_index + 2].width,
-					skyline_0r[skyline_index + 2].y - tshape->vru,
-					tshape->hr });
+					skyline_0r[skyline_index + 2].y - tshape.vru,
+					tshape.hr });
 				// merge
 				coord_t skyline_height_bk = skyline_0r[skyline_index + 2].y;
-				merge_skylines(skyline_0r);
+				skyline_0r.merge();
 				// delta
-				if (min_delta > skyline_0r.size() - _skyline.size()) {
-					min_delta = skyline_0r.size() - _skyline.size();
-					tshape->rotation = Rotation::_0_;
-					tshape->lb_point = lb_point_0r;
+				if (min_delta > skyline_0r.size() - ws.skyline.size()) {
+					min_delta = skyline_0r.size() - ws.skyline.size();
+					placement.rotation = Rotation::_0_;
+					placement.lb_point = lb_point_0r;
 					skyline = skyline_0r;
 					skyline_height = skyline_height_bk;
 				}
 			}
 
 			if (skyline_index + 1 < skyline_90.size()
-				&& tshape->vru <= skyline_90[skyline_index + 1].width
-				&& tshape->hr == space.hr
-				&& tshape->vrd <= space.width) {
+				&& tshape.vru <= skyline_90[skyline_index + 1].width
+				&& tshape.hr == space.hr
+				&& tshape.vrd <= space.width) {
 				// lb_point
-				point_t lb_point_90 = { skyline_90[skyline_index].x + space.width - tshape->vrd, skyline_90[skyline_index].y + tshape->hd };
+				point_t lb_point_90 = { skyline_90[skyline_index].x + space.width - tshape.vrd, skyline_90[skyline_index].y + tshape.hd };
 				// update
-				skyline_90[skyline_index].width -= tshape->vrd;
+				skyline_90[skyline_index].width -= tshape.vrd;
 				// add
-				skyline_90.insert(skyline_90.begin() + skyline_index + 1, {
+				skyline_90.insert(skyline_index + 1, {
 					skyline_90[skyline_index].x + skyline_90[skyline_index].width,
-					skyline_90[skyline_index].y + tshape->hd,
-					tshape->vld });
-				skyline_90.insert(skyline_90.begin() + skyline_index + 2, {
+					skyline_90[skyline_index].y + tshape.hd,
+					tshape.vld });
+				skyline_90.insert(skyline_index + 2, {
 					skyline_90[skyline_index + 1].x + skyline_90[skyline_index + 1].width,
-					skyline_90[skyline_index + 1].y - tshape->hl,
-					tshape->vlu });
+					skyline_90[skyline_index + 1].y - tshape.hl,
+					tshape.vlu });
 				// delete right
-				skyline_90[skyline_index + 3].x += tshape->vru;
-				skyline_90[skyline_index + 3].width -= tshape->vru;
+				skyline_90[skyline_index + 3].x += tshape.vru;
+				skyline_90[skyline_index + 3].width -= tshape.vru;
 				// merge
 				coord_t skyline_height_bk = skyline_90[skyline_index + 1].y;
-				merge_skylines(skyline_90);
+				skyline_90.merge();
 				// delta
-				if (min_delta > skyline_90.size() - _skyline.size()) {
-					min_delta = skyline_90.size() - _skyline.size();
-					tshape->rotation = Rotation::_90_;
-					tshape->lb_point = lb_point_90;
+				if (min_delta > skyline_90.size() - ws.skyline.size()) {
+					min_delta = skyline_90.size() - ws.skyline.size();
+					placement.rotation = Rotation::_90_;
+					placement.lb_point = lb_point_90;
 					skyline = skyline_90;
 					skyline_height = skyline_height_bk;
 				}
 			}
 
 			if (skyline_index + 1 < skyline_180.size() && skyline_index >= 1
-				&& tshape->hl <= skyline_180[skyline_index + 1].width
-				&& tshape->hr <= skyline_180[skyline_index - 1].width
-				&& tshape->vlu == space.hr
-				&& tshape->vru == space.hl
-				&& tshape->hu == space.width) {
+				&& tshape.hl <= skyline_180[skyline_index + 1].width
+				&& tshape.hr <= skyline_180[skyline_index - 1].width
+				&& tshape.vlu == space.hr
+				&& tshape.vru == space.hl
+				&& tshape.hu == space.width) {
 				// lb_point
-				point_t lb_point_180 = { skyline_180[skyline_index].x + tshape->hu + tshape->hl, skyline_180[skyline_index].y + tshape->vlu + tshape->vld };
+				point_t lb_point_180 = { skyline_180[skyline_index].x + tshape.hu + tshape.hl, skyline_180[skyline_index].y + tshape.vlu + tshape.vld };
 				// update
-				skyline_180[skyline_index].x -= tshape->hr;
-				skyline_180[skyline_index].y += (tshape->vru + tshape->vrd);
-				skyline_180[skyline_index].width = tshape->hd;
+				skyline_180[skyline_index].x -= tshape.hr;
+				skyline_180[skyline_index].y += (tshape.vru + tshape.vrd);
+				skyline_180[skyline_index].width = tshape.hd;
 				// delete left
-				skyline_180[skyline_index - 1].width -= tshape->hr;
+				skyline_180[skyline_index - 1].width -= tshape.hr;
 				// delete right
-				skyline_180[skyline_index + 1].x += tshape->hl;
-				skyline_180[skyline_index + 1].width -= tshape->hl;
+				skyline_180[skyline_index + 1].x += tshape.hl;
+				skyline_180[skyline_index + 1].width -= tshape.hl;
 				// merge
 				coord_t skyline_height_bk = skyline_180[skyline_index].y;
-				merge_skylines(skyline_180);
+				skyline_180.merge();
 				// delta
-				if (min_delta > skyline_180.size() - _skyline.size()) {
-					min_delta = skyline_180.size() - _skyline.size();
-					tshape->rotation = Rotation::_180_;
-					tshape->lb_point = lb_point_180;
+				if (min_delta > skyline_180.size() - ws.skyline.size()) {
+					min_delta = skyline_180.size() - ws.skyline.size();
+					placement.rotation = Rotation::_180_;
+					placement.lb_point = lb_point_180;
 					skyline = skyline_180;
 					skyline_height = skyline_height_bk;
 				}
 			}
 
 			if (skyline_index >= 1
-				&& tshape->vlu <= skyline_270[skyline_index - 1].width
-				&& tshape->hl == space.hl
-				&& tshape->vld <= space.width) {
+				&& tshape.vlu <= skyline_270[skyline_index - 1].width
+				&& tshape.hl == space.hl
+				&& tshape.vld <= space.width) {
 				// lb_point
-				point_t lb_point_270 = { skyline_270[skyline_index].x + tshape->vld, skyline_270[skyline_index].y };
+				point_t lb_point_270 = { skyline_270[skyline_index].x + tshape.vld, skyline_270[skyline_index].y };
 				// update
-				skyline_270[skyline_index].x -= tshape->vlu;
-				skyline_270[skyline_index].y += (tshape->hl + tshape->hu);
-				skyline_270[skyline_index].width = tshape->vru;
+				skyline_270[skyline_index].x -= tshape.vlu;
+				skyline_270[skyline_index].y += (tshape.hl + tshape.hu);
+				skyline_270[skyline_index].width = tshape.vru;
 				// add
-				skyline_270.insert(skyline_270.begin() + skyline_index + 1, {
+				skyline_270.insert(skyline_index + 1, {
 					skyline_270[skyline_index].x + skyline_270[skyline_index].width,
-					skyline_270[skyline_index].y + tshape->hr,
-					tshape->vrd });
-				skyline_270.insert(skyline_270.begin() + skyline_index + 2, {
+					skyline_270[skyline_index].y + tshape.hr,
+					tshape.vrd });
+				skyline_270.insert(skyline_index + 2, {
 					skyline_270[skyline_index + 1].x + skyline_270[skyline_index + 1].width,
-					skyline_270[skyline_index + 1].y - tshape->hd,
-					space.width - tshape->vld });
+					skyline_270[skyline_index + 1].y - tshape.hd,
+					space.width - tshape.vld });
 				// delete left
-				skyline_270[skyline_index - 1].width -= tshape->vlu;
+				skyline_270[skyline_index - 1].width -= tshape.vlu;
 				// merge
 				coord_t skyline_height_bk = skyline_270[skyline_index + 1].y;
-				merge_skylines(skyline_270);
+				skyline_270.merge();
 				// delta
-				if (min_delta > skyline_270.size() - _skyline.size()) {
-					min_delta = skyline_270.size() - _skyline.size();
-					tshape->rotation = Rotation::_270_;
-					tshape->lb_point = lb_point_270;
+				if (min_delta > skyline_270.size() - ws.skyline.size()) {
+					min_delta = skyline_270.size() - ws.skyline.size();
+					placement.rotation = Rotation::_270_;
+					placement.lb_point = lb_point_270;
 					skyline = skyline_270;
 					skyline_height = skyline_height_bk;
 				}
@@ -852,69 +1636,69 @@ namespace mbp {
 		}
 
 		/// Cֲ
-		bool score_concave_for_skyline_bottom_left(size_t skyline_index, concave_ptr &concave, skyline_t &skyline, coord_t &skyline_height) {
-			SkylineSpace space = skyline_nodo_to_space(skyline_index);
-			skyline_t skyline_0l = _skyline, skyline_0r = _skyline;
+		bool score_concave_for_skyline_bottom_left(const Workspace &ws, size_t skyline_index, const ConcaveDims &concave, placement_t &placement, SkylinePatch &skyline, coord_t &skyline_height) const {
+			SkylineSpace space = skyline_nodo_to_space(ws, skyline_index);
+			SkylinePatch skyline_0l(ws.skyline, skyline_index), skyline_0r(ws.skyline, skyline_index);
 			int min_delta = numeric_limits<int>::max();
 
-			if (concave->hd <= space.width) { // 0&
+			if (concave.hd <= space.width) { // 0&
 				// lb_point
 				point_t lb_point_0l = { skyline_0l[skyline_index].x, skyline_0l[skyline_index].y };
 				// update
-				skyline_0l[skyline_index].y += concave->vld;
-				skyline_0l[skyline_index].width = concave->hl;
+				skyline_0l[skyline_index].y += concave.vld;
+				skyline_0l[skyline_index].width = concave.hl;
 				// add
-				skyline_0l.insert(skyline_0l.begin() + skyline_index + 1, {
+				skyline_0l.insert(skyline_index + 1, {
 					skyline_0l[skyline_index].x + skyline_0l[skyline_index].width,
-					skyline_0l[skyline_index].y - concave->vlu,
-					concave->hu });
-				skyline_0l.insert(skyline_0l.begin() + skyline_index + 2, {
+					skyline_0l[skyline_index].y - concave.vlu,
+					concave.hu });
+				skyline_0l.insert(skyline_index + 2, {
 					skyline_0l[skyline_index + 1].x + skyline_0l[skyline_index + 1].width,
-					skyline_0l[skyline_index + 1].y + concave->vru,
-					concave->hr });
-				skyline_0l.insert(skyline_0l.begin() + skyline_index + 3, {
+					skyline_0l[skyline_index + 1].y + concave.vru,
+					concave.hr });
+				skyline_0l.insert(skyline_index + 3, {
 					skyline_0l[skyline_index + 2].x + skyline_0l[skyline_index + 2].width,
-					skyline_0l[skyline_index + 2].y - concave->vrd,
-					space.width - concave->hd });
+					skyline_0l[skyline_index + 2].y - concave.vrd,
+					space.width - concave.hd });
 				// merge
 				coord_t skyline_height_bk = max(skyline_0l[skyline_index].y, skyline_0l[skyline_index + 2].y);
-				merge_skylines(skyline_0l);
+				skyline_0l.merge();
 				// delta
-				if (min_delta > skyline_0l.size() - _skyline.size()) {
-					min_delta = skyline_0l.size() - _skyline.size();
-					concave->rotation = Rotation::_0_;
-					concave->lb_point = lb_point_0l;
+				if (min_delta > skyline_0l.size() - ws.skyline.size()) {
+					min_delta = skyline_0l.size() - ws.skyline.size();
+					placement.rotation = Rotation::_0_;
+					placement.lb_point = lb_point_0l;
 					skyline = skyline_0l;
 					skyline_height = skyline_height_bk;
 				}
 			}
 
-			if (concave->hd < space.width) { // 0&
+			if (concave.hd < space.width) { // 0&
 				// lb_point
-				point_t lb_point_0r = { skyline_0r[skyline_index].x + space.width - concave->hd, skyline_0r[skyline_index].y };
+				point_t lb_point_0r = { skyline_0r[skyline_index].x + space.width - concave.hd, skyline_0r[skyline_index].y };
 				// update
-				skyline_0r[skyline_index].width -= concave->hd;
+				skyline_0r[skyline_index].width -= concave.hd;
 				// add
-				skyline_0r.insert(skyline_0r.begin() + skyline_index + 1, {
+				skyline_0r.insert(skyline_index + 1, {
 					skyline_0r[skyline_index].x + skyline_0r[skyline_index].width,
-					skyline_0r[skyline_index].y + concave->vld,
-					concave->hl });
-				skyline_0r.insert(skyline_0r.begin() + skyline_index + 2, {
+					skyline_0r[skyline_index].y + concave.vld,
+					concave.hl });
+				skyline_0r.insert(skyline_index + 2, {
 					skyline_0r[skyline_index + 1].x + skyline_0r[skyline_index + 1].width,
-					skyline_0r[skyline_index + 1].y - concave->vlu,
-					concave->hu });
-				skyline_0r.insert(skyline_0r.begin() + skyline_index + 3, {
+					skyline_0r[skyline_index + 1].y - concave.vlu,
+					concave.hu });
+				skyline_0r.insert(skyline_index + 3, {
 					skyline_0r[skyline_index + 2].x + skyline_0r[skyline_index + 2].width,
-					skyline_0r[skyline_index + 2].y + concave->vru,
-					concave->hr });
+					skyline_0r[skyline_index + 2].y + concave.vru,
+					concave.hr });
 				// merge
 				coord_t skyline_height_bk = max(skyline_0r[skyline_index + 1].y, skyline_0r[skyline_index + 3].y);
-				merge_skylines(skyline_0r);
+				skyline_0r.merge();
 				// delta
-				if (min_delta > skyline_0r.size() - _skyline.size()) {
-					min_delta = skyline_0r.size() - _skyline.size();
-					concave->rotation = Rotation::_0_;
-					concave->lb_point = lb_point_0r;
+				if (min_delta > skyline_0r.size() - ws.skyline.size()) {
+					min_delta = skyline_0r.size() - ws.skyline.size();
+					placement.rotation = Rotation::_0_;
+					placement.lb_point = lb_point_0r;
 					skyline = skyline_0r;
 					skyline_height = skyline_height_bk;
 				}
@@ -925,37 +1709,52 @@ namespace mbp {
 		}
 
 		/// ϲͬһlevelskylineڵ.
-		static void merge_skylines(skyline_t &skyline) {
-			skyline.erase(
-				remove_if(skyline.begin(), skyline.end(), [](skylinenode_t &lhs) { return lhs.width <= 0; }),
-				skyline.end()
-			);
-			for (size_t i = 0; i < skyline.size() - 1; ++i) {
-				if (skyline[i].y == skyline[i + 1].y) {
-					skyline[i].width += skyline[i + 1].width;
-					skyline.erase(skyline.begin() + i + 1);
-					--i;
-				}
+		static void merge_skylines(skyline_t &skyline) { merge_skylines(skyline, 0, skyline.size()); }
+
+		/// ֻϲ޸ĵĽڵ[first, last)ɾȥΪ0Ľڵ㲢ͬߵڽڵϲ
+		/// skylineǺϲ״̬ɨ贰ڼҸһڵ㼴ɣĽڵֻǰһ
+		static void merge_skylines(skyline_t &skyline, size_t first, size_t last) {
+			first = first > 0 ? first - 1 : 0;
+			last = min(last + 1, skyline.size());
+			size_t size = first;
+			for (size_t i = first; i < last; ++i) {
+				if (skyline[i].width <= 0) { continue; }
+				if (size > first && skyline[size - 1].y == skyline[i].y) { skyline[size - 1].width += skyline[i].width; }
+				else { skyline[size++] = skyline[i]; }
 			}
+			skyline.erase(skyline.begin() + size, skyline.begin() + last);
 		}
 
 	private:
 		// 
-		const vector<polygon_ptr> &_src;
 		coord_t _bin_width;
 		coord_t _bin_height;
 
 		// 
-		vector<polygon_ptr> _dst;
+		vector<placement_t> _dst;
 		coord_t _obj_area;
 
-		skyline_t _skyline;
+		// Ķδ洢±Ϊе±
+		shared_ptr<const PolygonStore> _store;
+		const vector<Shape> &_shapes;
+		const vector<coord_t> &_areas;
+		const vector<coord_t> &_max_lengths;
+		const vector<PolygonDims> &_dims;
+		const vector<coord_t> &_min_widths;
+
 		vector<SortRule> _sort_rules; // бRLS
-		list<size_t> _polygons;		  // SortRulesequence൱ָ룬ʹlistɾΪ
-		//TabuTable _tabu_table;        // ɱ
+		TabuTable _tabu_table;        // ɱ¼sequence
+
+		// 
+		ThreadPool *_pool;              // Ϊʱ
+		size_t _batch_size;             // ÿ
+
+		Scratch *_scratch; // RLSڼõĻ壬ʱΪ
 		discrete_distribution<> _discrete_dist;   // ɢʷֲѡ(ѡsequence_polygons)
 		uniform_int_distribution<> _uniform_dist; // ȷֲڽsequence˳
-		default_random_engine &_gen;
+		default_random_engine _gen;               // ѡȻ
+
+		Kernels _kernels; // ʵ״ѡĹں
 	};
 
 }
@@ -0,0 +1,327 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#ifndef SMARTMPW_POLYGONFILE_HPP
+#define SMARTMPW_POLYGONFILE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <charconv>
+#include <type_traits>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#include "Utils.hpp"
+
+/// ͽļʽCheckerãֻ׼utils::MappedFile
+///
+/// ıʽÿռһ(x,y)УǰһΪ"Polygon:""In Polygon:"/"Out Polygon:"⣩
+/// ƸʽС򣬸ξ4ֽڶ룬ֱӳڴϷʣ
+///   Header                     16ֽ
+///   uint8_t  tags[record_num]  ״ǩȡֵͬShape뵽4ֽ
+///   uint32_t offsets[record_num + 1]  еʼ
+///   int32_t  coords[2 * point_num]    أxy
+/// ļļ¼Ρν
+namespace polygon_file {
+
+	using namespace std;
+
+	enum class Kind : uint16_t { Instance = 0, Solution = 1 };
+
+	inline constexpr char Magic[4] = { 'M', 'P', 'W', 'B' };
+	inline constexpr uint16_t Version = 1;
+	inline constexpr uint8_t InvalidTag = 0xff;
+
+	struct Header {
+		char magic[4];
+		uint16_t version;
+		uint16_t kind;
+		uint32_t record_num;
+		uint32_t point_num;
+	};
+	static_assert(sizeof(Header) == 16, "binary header must stay 16 bytes");
+
+	struct XY { int32_t x, y; };
+
+	inline size_t align4(size_t n) { return (n + 3) & ~size_t(3); }
+
+	inline bool is_binary(const char *data, size_t size) { return size >= sizeof(Magic) && memcmp(data, Magic, sizeof(Magic)) == 0; }
+
+	inline bool has_binary_extension(const string &path) { return path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0; }
+
+	/// Ͱֲʶ״8ʱΪΣΪT
+	inline uint8_t shape_tag(const XY *points, size_t n) {
+		if (n == 4) { return 0; }
+		if (n == 6) { return 1; }
+		if (n != 8) { return InvalidTag; }
+		int sign_changes = 0;
+		bool prev_left = false;
+		for (size_t i = 0; i <= n; ++i) {
+			const XY &a = points[(i + n - 1) % n], &b = points[i % n], &c = points[(i + 1) % n];
+			long long cross = static_cast<long long>(b.x - a.x) * (c.y - b.y) - static_cast<long long>(b.y - a.y) * (c.x - b.x);
+			bool left = cross > 0;
+			if (i > 0 && left != prev_left) { ++sign_changes; }
+			prev_left = left;
+		}
+		if (sign_changes == 4) { return 2; }
+		if (sign_changes == 2) { return 3; }
+		return InvalidTag;
+	}
+
+	/// ıɨ裬ʱشposָλ
+	class TextScanner {
+	public:
+		static void skip_spaces(const char *&pos, const char *end) {
+			while (pos != end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) { ++pos; }
+		}
+
+		/// ȡѡŵʮΪʧ
+		template<typename T>
+		static bool scan_int(const char *&pos, const char *end, T &value) {
+			skip_spaces(pos, end);
+			bool negative = pos != end && *pos == '-';
+			if (negative || (pos != end && *pos == '+')) { ++pos; }
+			if (pos == end || *pos < '0' || *pos > '9') { return false; }
+			long long result = 0;
+			for (; pos != end && *pos >= '0' && *pos <= '9'; ++pos) {
+				result = result * 10 + (*pos - '0');
+				if (result > numeric_limits<T>::max()) { return false; }
+			}
+			value = static_cast<T>(negative ? -result : result);
+			return true;
+		}
+
+		/// ȡ꣺갴scan_intȡ꣨CheckerСָ
+		template<typename T>
+		static bool scan_coord(const char *&pos, const char *end, T &value) {
+			if constexpr (is_floating_point<T>::value) {
+				skip_spaces(pos, end);
+				bool negative = pos != end && *pos == '-';
+				if (negative || (pos != end && *pos == '+')) { ++pos; }
+				if (pos == end || !((*pos >= '0' && *pos <= '9') || *pos == '.')) { return false; } // infnan
+				from_chars_result result = from_chars(pos, end, value);
+				if (result.ec != errc()) { return false; }
+				pos = result.ptr;
+				if (negative) { value = -value; }
+				return true;
+			} else {
+				return scan_int(pos, end, value);
+			}
+		}
+
+		/// һеȫ(x,y)׷ӵpoints֮ǰ
+		template<typename Points>
+		static const char *parse_points(const char *&pos, const char *end, Points &points) {
+			points.clear();
+			return append_points(pos, end, points);
+		}
+
+		/// һеȫ(x,y)׷ӵpointsĩβпɹһĵ
+		template<typename Points>
+		static const char *append_points(const char *&pos, const char *end, Points &points) {
+			while (true) {
+				skip_spaces(pos, end);
+				if (pos == end) { return nullptr; }
+				if (*pos != '(') { return "expected '('"; }
+				++pos;
+				decltype(points.front().x) x, y;
+				if (!scan_coord(pos, end, x)) { return "expected number x"; }
+				skip_spaces(pos, end);
+				if (pos == end || *pos != ',') { return "expected ','"; }
+				++pos;
+				if (!scan_coord(pos, end, y)) { return "expected number y"; }
+				skip_spaces(pos, end);
+				if (pos == end || *pos != ')') { return "expected ')'"; }
+				++pos;
+				points.push_back({ x, y });
+			}
+		}
+	};
+
+	/// ӳڴϵֻͼκ
+	class View {
+	public:
+		View() : _record_num(0), _point_num(0), _tags(nullptr), _offsets(nullptr), _coords(nullptr) {}
+
+		/// Уļͷ͸γȣʧʱش
+		const char *open(const char *data, size_t size, Kind kind) {
+			if (!is_binary(data, size) || size < sizeof(Header)) { return "not a binary polygon file"; }
+			Header header;
+			memcpy(&header, data, sizeof(Header));
+			if (header.version != Version) { return "unsupported binary version"; }
+			if (header.kind != static_cast<uint16_t>(kind)) { return kind == Kind::Instance ? "expected an instance file" : "expected a solution file"; }
+			if (kind == Kind::Solution && header.record_num % 2) { return "solution must hold in/out polygon pairs"; }
+			size_t tags_size = align4(header.record_num);
+			size_t offsets_size = (static_cast<size_t>(header.record_num) + 1) * sizeof(uint32_t);
+			size_t coords_size = static_cast<size_t>(header.point_num) * 2 * sizeof(int32_t);
+			if (size != sizeof(Header) + tags_size + offsets_size + coords_size) { return "file size does not match header"; }
+			_record_num = header.record_num;
+			_point_num = header.point_num;
+			_tags = reinterpret_cast<const uint8_t *>(data + sizeof(Header));
+			_offsets = reinterpret_cast<const uint32_t *>(data + sizeof(Header) + tags_size);
+			_coords = reinterpret_cast<const int32_t *>(data + sizeof(Header) + tags_size + offsets_size);
+			if (_offsets[0] != 0 || _offsets[_record_num] != _point_num) { return "point offsets do not cover the coordinate pool"; }
+			for (size_t i = 0; i < _record_num; ++i) {
+				if (_offsets[i] > _offsets[i + 1]) { return "point offsets are not ascending"; }
+				if (_tags[i] > 3) { return "unknown shape tag"; }
+			}
+			return nullptr;
+		}
+
+		size_t record_num() const { return _record_num; }
+
+		uint8_t tag(size_t i) const { return _tags[i]; }
+
+		size_t point_num(size_t i) const { return _offsets[i + 1] - _offsets[i]; }
+
+		size_t point_num() const { return _point_num; }
+
+		/// i¼еʼλ
+		size_t point_offset(size_t i) const { return _offsets[i]; }
+
+		const XY *points(size_t i) const { return reinterpret_cast<const XY *>(_coords) + _offsets[i]; }
+
+	private:
+		size_t _record_num;
+		size_t _point_num;
+		const uint8_t *_tags;
+		const uint32_t *_offsets;
+		const int32_t *_coords;
+	};
+
+	/// ¼˳ۻΣһдļ
+	class Writer {
+	public:
+		explicit Writer(Kind kind) : _kind(kind), _offsets(1, 0) {}
+
+		template<typename Points>
+		void add(uint8_t tag, const Points &points) {
+			_tags.push_back(tag);
+			for (auto &point : points) { _coords.push_back({ static_cast<int32_t>(point.x), static_cast<int32_t>(point.y) }); }
+			_offsets.push_back(static_cast<uint32_t>(_coords.size()));
+		}
+
+		bool save(const string &path) const {
+			Header header;
+			memcpy(header.magic, Magic, sizeof(Magic));
+			header.version = Version;
+			header.kind = static_cast<uint16_t>(_kind);
+			header.record_num = static_cast<uint32_t>(_tags.size());
+			header.point_num = static_cast<uint32_t>(_coords.size());
+
+			ofstream ofs(path, ios::binary);
+			if (!ofs.is_open()) {
+				cerr << "Error binary path: can not open " << path << endl;
+				return false;
+			}
+			static const char padding[4] = { 0, 0, 0, 0 };
+			ofs.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+			ofs.write(reinterpret_cast<const char *>(_tags.data()), _tags.size());
+			ofs.write(padding, align4(_tags.size()) - _tags.size());
+			ofs.write(reinterpret_cast<const char *>(_offsets.data()), _offsets.size() * sizeof(uint32_t));
+			ofs.write(reinterpret_cast<const char *>(_coords.data()), _coords.size() * sizeof(XY));
+			return ofs.good();
+		}
+
+	private:
+		Kind _kind;
+		vector<uint8_t> _tags;
+		vector<uint32_t> _offsets;
+		vector<XY> _coords;
+	};
+
+	/// ıתƣ"In Polygon:""Out Polygon:"жΪļ
+	inline bool text_to_binary(const string &src, const string &dst) {
+		utils::MappedFile file(src);
+		if (!file.is_open()) {
+			cerr << "Error text path: can not open " << src << endl;
+			return false;
+		}
+		const char *begin = file.data(), *end = begin + file.size();
+		Kind kind = Kind::Instance;
+		vector<uint8_t> tags;
+		vector<vector<XY>> polygons;
+		vector<XY> points;
+		int line_no = 1;
+		for (const char *line = begin; line < end; ++line_no) {
+			const char *line_end = static_cast<const char *>(memchr(line, '\n', end - line));
+			if (!line_end) { line_end = end; }
+			if (*line == 'I' || *line == 'O') { kind = Kind::Solution; }
+			else if (*line == '(') {
+				const char *pos = line;
+				const char *error = TextScanner::parse_points(pos, line_end, points);
+				uint8_t tag = error ? InvalidTag : shape_tag(points.data(), points.size());
+				if (!error && tag == InvalidTag) { pos = line; error = "polygon is not a rectangle, L, T or U shape"; }
+				if (error) {
+					cerr << "Error text format: " << src << ":" << line_no << ":" << pos - line + 1 << ": " << error << endl;
+					return false;
+				}
+				tags.push_back(tag);
+				polygons.push_back(points);
+			}
+			line = line_end + 1;
+		}
+		if (kind == Kind::Solution && polygons.size() % 2) {
+			cerr << "Error text format: " << src << ": solution must hold in/out polygon pairs" << endl;
+			return false;
+		}
+		Writer writer(kind);
+		for (size_t i = 0; i < polygons.size(); ++i) {
+			// ε״Ϊ׼ǷһChecker
+			writer.add(kind == Kind::Solution ? tags[i & ~size_t(1)] : tags[i], polygons[i]);
+		}
+		return writer.save(dst);
+	}
+
+	inline bool binary_to_text(const string &src, const string &dst) {
+		utils::MappedFile file(src);
+		if (!file.is_open()) {
+			cerr << "Error binary path: can not open " << src << endl;
+			return false;
+		}
+		Header header;
+		if (file.size() < sizeof(Header)) {
+			cerr << "Error binary format: " << src << ": not a binary polygon file" << endl;
+			return false;
+		}
+		memcpy(&header, file.data(), sizeof(Header));
+		Kind kind = header.kind == static_cast<uint16_t>(Kind::Solution) ? Kind::Solution : Kind::Instance;
+		View view;
+		if (const char *error = view.open(file.data(), file.size(), kind)) {
+			cerr << "Error binary format: " << src << ": " << error << endl;
+			return false;
+		}
+		ofstream ofs(dst);
+		if (!ofs.is_open()) {
+			cerr << "Error text path: can not open " << dst << endl;
+			return false;
+		}
+		for (size_t i = 0; i < view.record_num(); ++i) {
+			ofs << (kind == Kind::Instance ? "Polygon:" : (i % 2 ? "Out Polygon:" : "In Polygon:")) << "\n";
+			const XY *points = view.points(i);
+			for (size_t j = 0; j < view.point_num(i); ++j) { ofs << "(" << points[j].x << "," << points[j].y << ")"; }
+			ofs << "\n";
+		}
+		return ofs.good();
+	}
+
+	/// Դļж򣺶תΪııתΪ
+	inline bool convert(const string &src, const string &dst) {
+		bool binary;
+		{
+			utils::MappedFile file(src);
+			if (!file.is_open()) {
+				cerr << "Error convert path: can not open " << src << endl;
+				return false;
+			}
+			binary = is_binary(file.data(), file.size());
+		}
+		return binary ? binary_to_text(src, dst) : text_to_binary(src, dst);
+	}
+}
+
+#endif // SMARTMPW_POLYGONFILE_HPP
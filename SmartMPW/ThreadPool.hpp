@@ -0,0 +1,170 @@
+//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#ifndef SMARTMPW_THREADPOOL_HPP
+#define SMARTMPW_THREADPOOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <condition_variable>
+
+namespace utils {
+
+	using namespace std;
+
+	/// ȡ̳߳أÿ߳ά˫˶УLIFOȡ񣬿ʱͷȡ
+	class ThreadPool {
+
+		struct TaskQueue {
+			mutex mtx;
+			deque<function<void()>> tasks;
+		};
+
+	public:
+
+		ThreadPool() = delete;
+
+		/// thread_numΪ߳Ϊ0ʱȫɵȴִ߳У
+		explicit ThreadPool(unsigned thread_num) :
+			_queues(max(thread_num, 1u)), _pending(0), _next_queue(0), _stop(false) {
+			_threads.reserve(thread_num);
+			for (unsigned i = 0; i < thread_num; ++i) {
+				_threads.emplace_back([this, i]() { worker_loop(i); });
+			}
+		}
+
+		~ThreadPool() {
+			{
+				lock_guard<mutex> guard(_idle_mtx);
+				_stop = true;
+			}
+			_idle_cv.notify_all();
+			for (auto &t : _threads) { t.join(); }
+		}
+
+		unsigned size() const { return static_cast<unsigned>(_threads.size()); }
+
+		/// ߳ύضУⲿ߳ύ
+		void submit(function<void()> task) {
+			size_t qi = local_pool() == this ? local_index() : _next_queue++ % _queues.size();
+			{
+				lock_guard<mutex> guard(_queues[qi].mtx);
+				_queues[qi].tasks.push_back(move(task));
+			}
+			++_pending;
+			{ lock_guard<mutex> guard(_idle_mtx); } // ֹѶʧ
+			_idle_cv.notify_one();
+		}
+
+	private:
+		void worker_loop(size_t index) {
+			local_pool() = this;
+			local_index() = index;
+			while (true) {
+				function<void()> task;
+				if (try_get(index, task)) { task(); continue; }
+				unique_lock<mutex> lock(_idle_mtx);
+				_idle_cv.wait(lock, [this]() { return _stop || _pending > 0; });
+				if (_stop && _pending == 0) { return; }
+			}
+		}
+
+		/// ȡضβȡͷ
+		bool try_get(size_t index, function<void()> &task) {
+			if (_pending == 0) { return false; }
+			for (size_t i = 0; i < _queues.size(); ++i) {
+				TaskQueue &queue = _queues[(index + i) % _queues.size()];
+				lock_guard<mutex> guard(queue.mtx);
+				if (queue.tasks.empty()) { continue; }
+				if (i == 0) { task = move(queue.tasks.back()); queue.tasks.pop_back(); }
+				else { task = move(queue.tasks.front()); queue.tasks.pop_front(); }
+				--_pending;
+				return true;
+			}
+			return false;
+		}
+
+		static ThreadPool *&local_pool() { static thread_local ThreadPool *pool = nullptr; return pool; }
+
+		static size_t &local_index() { static thread_local size_t index = 0; return index; }
+
+	private:
+		vector<TaskQueue> _queues;
+		vector<thread> _threads;
+		atomic<size_t> _pending;    // δȡߵ
+		atomic<size_t> _next_queue; // ⲿύת±
+		bool _stop;
+		mutex _idle_mtx;
+		condition_variable _idle_cv;
+	};
+
+	/// 飺ڶУֻ̳߳ύȡ壻ڲɼͬһύ
+	/// wait()ڼֻ߳Эִб񣬱ȴѿʼ
+	/// ڵȴִĳһȵRLSӱ
+	class TaskGroup {
+
+		/// űִУ״̬干
+		struct State {
+			mutex mtx;
+			condition_variable cv;
+			deque<function<void()>> tasks; // δȡ
+			size_t unfinished = 0;         // δɵȡִе
+		};
+
+	public:
+
+		TaskGroup() = delete;
+
+		explicit TaskGroup(ThreadPool &pool) : _pool(pool), _state(make_shared<State>()) {}
+
+		~TaskGroup() { wait(); }
+
+		void run(function<void()> task) {
+			{
+				lock_guard<mutex> guard(_state->mtx);
+				_state->tasks.push_back(move(task));
+				++_state->unfinished;
+			}
+			_state->cv.notify_all(); // ѵȴ߳ȡ
+			if (_pool.size() == 0) { return; } // ûй߳ʱȫɵȴִ߳
+			shared_ptr<State> state = _state;
+			_pool.submit([state]() {
+				unique_lock<mutex> lock(state->mtx);
+				if (state->tasks.empty()) { return; } // ѱȴ̻߳ȡ
+				run_front(*state, lock);
+			});
+		}
+
+		void wait() {
+			unique_lock<mutex> lock(_state->mtx);
+			while (_state->unfinished > 0) {
+				if (_state->tasks.empty()) { _state->cv.wait(lock); }
+				else { run_front(*_state, lock); }
+			}
+		}
+
+	private:
+		/// ȡִжִڼͷһʱѵȴ߳
+		static void run_front(State &state, unique_lock<mutex> &lock) {
+			function<void()> task = move(state.tasks.front());
+			state.tasks.pop_front();
+			lock.unlock();
+			task();
+			lock.lock();
+			if (--state.unfinished == 0) { state.cv.notify_all(); }
+		}
+
+	private:
+		ThreadPool &_pool;
+		shared_ptr<State> _state;
+	};
+
+}
+
+#endif // SMARTMPW_THREADPOOL_HPP
@@ -5,12 +5,27 @@
 #ifndef SMARTMPW_UTILS_HPP
 #define SMARTMPW_UTILS_HPP
 
+#include <cstring>
 #include <string>
+#include <vector>
+#include <charconv>
 #include <sstream>
 #include <fstream>
 #include <ctime>
+#include <chrono>
 #include <iomanip>
 #include <random>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 namespace utils {
 
@@ -43,6 +58,145 @@ namespace utils {
 		}
 	};
 
+	/// steady_clockʱԤ㣺ǽʱʱ߳ͽCPUʱӰ죬̼߳乲ֻ
+	class Deadline {
+	public:
+		using Clock = chrono::steady_clock;
+
+		/// ʱ
+		Deadline() : _start(Clock::now()), _end(Clock::time_point::max()) {}
+
+		explicit Deadline(double seconds) : _start(Clock::now()),
+			_end(_start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(seconds))) {}
+
+		bool expired() const { return Clock::now() >= _end; }
+
+		/// Դ𾭹
+		double elapsed() const { return chrono::duration<double>(Clock::now() - _start).count(); }
+
+	private:
+		Clock::time_point _start;
+		Clock::time_point _end;
+	};
+
+	/// ֻڴӳļʱپп
+	class MappedFile {
+	public:
+		MappedFile() = delete;
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		explicit MappedFile(const string &path) : _data(nullptr), _size(0), _open(false) {
+		#ifdef _WIN32
+			_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			_mapping = nullptr;
+			if (_file == INVALID_HANDLE_VALUE) { return; }
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(_file, &size)) { return; }
+			_size = static_cast<size_t>(size.QuadPart);
+			_open = true;
+			if (_size == 0) { return; }
+			_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!_mapping) { _open = false; return; }
+			_data = static_cast<const char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+			_open = _data != nullptr;
+		#else
+			int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) { return; }
+			struct stat st;
+			if (fstat(fd, &st) == 0) {
+				_size = static_cast<size_t>(st.st_size);
+				_open = true;
+				if (_size > 0) {
+					void *addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if (addr == MAP_FAILED) { _open = false; }
+					else {
+						_data = static_cast<const char *>(addr);
+						madvise(addr, _size, MADV_SEQUENTIAL);
+					}
+				}
+			}
+			::close(fd); // ӳ佨Ҫļ
+		#endif
+		}
+
+		~MappedFile() {
+		#ifdef _WIN32
+			if (_data) { UnmapViewOfFile(_data); }
+			if (_mapping) { CloseHandle(_mapping); }
+			if (_file != INVALID_HANDLE_VALUE) { CloseHandle(_file); }
+		#else
+			if (_data) { munmap(const_cast<char *>(_data), _size); }
+		#endif
+		}
+
+		bool is_open() const { return _open; }
+
+		const char *data() const { return _data; }
+
+		size_t size() const { return _size; }
+
+	private:
+		const char *_data;
+		size_t _size;
+		bool _open;
+	#ifdef _WIN32
+		HANDLE _file;
+		HANDLE _mapping;
+	#endif
+	};
+
+	/// ıto_charsֱд뻺ʱдˢ
+	class BufferedWriter {
+	public:
+		BufferedWriter(const BufferedWriter &) = delete;
+		BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+		explicit BufferedWriter(const string &path, size_t capacity = 1 << 20) : _ofs(path), _buf(capacity), _size(0) {}
+
+		~BufferedWriter() { flush(); }
+
+		bool is_open() const { return _ofs.is_open(); }
+
+		BufferedWriter &operator<<(char c) {
+			if (_size == _buf.size()) { flush(); }
+			_buf[_size++] = c;
+			return *this;
+		}
+
+		BufferedWriter &operator<<(const char *str) { return write(str, strlen(str)); }
+
+		BufferedWriter &operator<<(long long value) {
+			if (_buf.size() - _size < MaxDigits) { flush(); }
+			_size = to_chars(_buf.data() + _size, _buf.data() + _buf.size(), value).ptr - _buf.data();
+			return *this;
+		}
+
+		BufferedWriter &operator<<(int value) { return *this << static_cast<long long>(value); }
+
+		BufferedWriter &write(const char *data, size_t len) {
+			if (_buf.size() - _size < len) {
+				flush();
+				if (len > _buf.size()) { _ofs.write(data, len); return *this; }
+			}
+			memcpy(_buf.data() + _size, data, len);
+			_size += len;
+			return *this;
+		}
+
+		void flush() {
+			if (_size) { _ofs.write(_buf.data(), _size); _size = 0; }
+			_ofs.flush();
+		}
+
+	private:
+		static constexpr size_t MaxDigits = 20; // long longʮƱʾ
+
+		ofstream _ofs;
+		vector<char> _buf;
+		size_t _size;
+	};
+
 	static void split_filename(const string &str, string &dir, string &file, string &id) {
 		size_t found1 = str.find_last_of("/\\");
 		size_t found2 = str.find_last_of("_");
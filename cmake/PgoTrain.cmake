@@ -0,0 +1,45 @@
+# 在WORK_DIR中运行插桩后的求解器，生成PGO profile
+# 参数：SOLVER INSTANCE_DIR WORK_DIR PROFILE_DIR TIME [LLVM_PROFDATA]
+
+set(TRAIN_INSTANCES
+	polygon_area_etc_input_1
+	polygon_area_etc_input_5
+	polygon_area_etc_input_9
+	Ln200r40
+	Tn200r40
+	Un200r40
+	Ln600r20
+	Tn600r60
+	Un600r80
+	Ln1000r40
+	Tn1000r40
+	Un1000r40
+)
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}/Instance" "${WORK_DIR}/Solution" "${PROFILE_DIR}")
+foreach(ins IN LISTS TRAIN_INSTANCES)
+	file(COPY "${INSTANCE_DIR}/${ins}.txt" DESTINATION "${WORK_DIR}/Instance")
+endforeach()
+
+foreach(ins IN LISTS TRAIN_INSTANCES)
+	message(STATUS "Training on ${ins}")
+	execute_process(
+		COMMAND "${SOLVER}" "${ins}" "${TIME}"
+		WORKING_DIRECTORY "${WORK_DIR}"
+		OUTPUT_QUIET
+		RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "Solver failed on ${ins}: ${result}")
+	endif()
+endforeach()
+
+if(LLVM_PROFDATA)
+	file(GLOB raw_profiles "${PROFILE_DIR}/*.profraw")
+	execute_process(
+		COMMAND "${LLVM_PROFDATA}" merge -output=${PROFILE_DIR}/default.profdata ${raw_profiles}
+		RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "llvm-profdata merge failed: ${result}")
+	endif()
+endif()